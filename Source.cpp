@@ -28,6 +28,77 @@ Save / Quit Game
 #include <sstream>
 #include <time.h>
 #include <iomanip>
+#include <cstdint>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <unordered_map>
+#include <memory>
+#include <functional>
+#include <chrono>
+#include <algorithm>
+#include <cstring>
+#include <string_view>
+#include <charconv>
+#include <filesystem>
+#include <coroutine>
+#include <atomic>
+#include <cmath>
+#include <bit>
+#include <memory_resource>
+#include <new>
+#include <cstdlib>
+#include <span>
+
+// POSIX Headers (mmap for the Sprite Atlas, write() for the Output Buffer and the terminal
+// size for the Battle Screen. Everything else falls back to the standard library or Win32.)
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/ioctl.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <signal.h>
+#define HAVE_POSIX 1
+
+// Session Server (epoll is Linux only, the fibers run on ucontext)
+#if defined(__linux__)
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <ucontext.h>
+#define HAVE_EPOLL 1
+#endif
+#elif defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <malloc.h>
+#endif
+
+// Embedded Sprites (PokemonSprites.h is generated by the embed-sprites build step)
+#if defined(__has_include) && !defined(POKEMON_NO_EMBEDDED_SPRITES)
+#if __has_include("PokemonSprites.h")
+#include "PokemonSprites.h"
+#define HAVE_EMBEDDED_SPRITES 1
+#endif
+#endif
+
+// SIMD Damage Kernels (x86 only, picked at runtime from what the CPU supports)
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#include <x86intrin.h>
+#define BATTLE_SIMD 1
+#define BATTLE_TARGET(isa) __attribute__((target(isa)))
+#elif defined(_MSC_VER) && defined(_M_X64)
+#include <immintrin.h>
+#include <intrin.h>
+#define BATTLE_SIMD 1
+#define BATTLE_TARGET(isa)
+#endif
 
 using namespace std;
 
@@ -36,59 +107,457 @@ const int MOVES = 2;
 const int PLAYER_MAX_POKEMON = 6;
 const int POKEMON_IN_GAME = 10;
 const int ITEMS_IN_GAME = 2;
+const int MAX_TURN_EVENTS = 8;
+const int POKEMON_MAX_LEVEL = 9999;
+const int POKEMON_MAX_HEALTH = 65535;
 
 // Global ENUMs
-enum PokemonSpecies { BULBASAUR, CHARMANDER, SQUIRTLE, CATERPIE, PIDGEY, PIKACHU, EKANS, ODDISH, DIGLETT, PSYDUCK };
+enum PokemonSpecies : uint8_t { BULBASAUR, CHARMANDER, SQUIRTLE, CATERPIE, PIDGEY, PIKACHU, EKANS, ODDISH, DIGLETT, PSYDUCK };
 enum ItemNames { ELIXIR, POKEBALL };
 enum Status { HIT, DEAD, REVIVE, CAUGHT, FAILED, MISSED, SUCCESS, NORMAL, SPECIAL, PLAYER, COMPUTER, LEVELUP, BATTLE_END, BATTLE_CONTINUE };
 enum MenuLocation { ATTACK, BAG, SELECTION, OVERVIEW };
+enum BattleActionType { ACTION_ATTACK, ACTION_ELIXIR, ACTION_POKEBALL, ACTION_SWAP, ACTION_FLEE };
+enum BattleEventType { EVENT_ATTACK, EVENT_ELIXIR, EVENT_POKEBALL, EVENT_SWAP, EVENT_FLEE, EVENT_VICTORY, EVENT_LEVELUP, EVENT_DEFEAT };
+enum BattlePhase { PHASE_ACTION, PHASE_REPLACE, PHASE_OVER };
+enum BattleInputKind { INPUT_NONE, INPUT_SELECTION, INPUT_ENTER };
 
 // Global Strings
-string DefaultSpeciesNames[] = { "Bulbasaur", "Charmander", "Squirtle", "Caterpie", "Pidgey", "Pikachu", "Ekans", "Oddish", "Diglett", "Psyduck" };
+constexpr const char *DefaultSpeciesNames[] = { "Bulbasaur", "Charmander", "Squirtle", "Caterpie", "Pidgey", "Pikachu", "Ekans", "Oddish", "Diglett", "Psyduck" };
 
-// Pokemon Data Struct (Contains Species Information)
-struct PokemonSpeciesData
+// Latency Histogram Struct (HDR style: every power of two of nanoseconds is split into 32
+// linear sub-buckets, so any value is kept to within 1 part in 32 from 1 ns to hours. Counts
+// only grow as far as the slowest value seen, and histograms of different threads or
+// sessions merge by adding their counts.)
+struct LatencyHistogram
 {
-	string Name;
-	int iconBegin;
-	int iconEnd;
-	string moveSet[MOVES];
+	static const int SUB_BUCKET_BITS = 5;
+	static const int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+
+	vector<uint64_t> counts;
+	uint64_t total = 0;
+	uint64_t sum = 0;
+	uint64_t largest = 0;
+
+	static size_t bucketOf(uint64_t value)
+	{
+		if (value < SUB_BUCKETS)
+		{
+			return static_cast<size_t>(value);
+		}
+
+		int shift = static_cast<int>(bit_width(value)) - 1 - SUB_BUCKET_BITS;
+		return static_cast<size_t>(shift + 1) * SUB_BUCKETS + static_cast<size_t>((value >> shift) - SUB_BUCKETS);
+	}
+
+	// Highest value that falls in the bucket
+	static uint64_t bucketHighest(size_t bucket)
+	{
+		if (bucket < SUB_BUCKETS)
+		{
+			return bucket;
+		}
+
+		int shift = static_cast<int>(bucket / SUB_BUCKETS) - 1;
+		uint64_t lowest = static_cast<uint64_t>(SUB_BUCKETS + bucket % SUB_BUCKETS) << shift;
+		return lowest + (uint64_t(1) << shift) - 1;
+	}
+
+	void record(uint64_t nanos)
+	{
+		size_t bucket = bucketOf(nanos);
+		if (bucket >= counts.size())
+		{
+			counts.resize(bucket + 1);
+		}
+
+		counts[bucket]++;
+		total++;
+		sum += nanos;
+		largest = max(largest, nanos);
+	}
+
+	void record(chrono::steady_clock::duration elapsed)
+	{
+		record(static_cast<uint64_t>(max<long long>(0, chrono::duration_cast<chrono::nanoseconds>(elapsed).count())));
+	}
+
+	void merge(const LatencyHistogram &other)
+	{
+		if (other.counts.size() > counts.size())
+		{
+			counts.resize(other.counts.size());
+		}
+
+		for (size_t i = 0; i < other.counts.size(); i++)
+		{
+			counts[i] += other.counts[i];
+		}
+
+		total += other.total;
+		sum += other.sum;
+		largest = max(largest, other.largest);
+	}
+
+	// Value at or below which percent of the values fall (0 if nothing was recorded)
+	uint64_t percentile(double percent) const
+	{
+		uint64_t rank = max<uint64_t>(1, static_cast<uint64_t>(ceil(percent / 100.0 * total)));
+		uint64_t seen = 0;
+
+		for (size_t i = 0; i < counts.size(); i++)
+		{
+			seen += counts[i];
+			if (seen >= rank)
+			{
+				return min(bucketHighest(i), largest);
+			}
+		}
+
+		return 0;
+	}
+
+	double mean() const
+	{
+		return (total > 0) ? static_cast<double>(sum) / total : 0.0;
+	}
+};
+
+// Latency Metrics (Input to frame runs from a selection or Enter being read to the next battle
+// frame being written, turn is resolveTurn, save is saveGame and store write is storeSave)
+enum LatencyMetric { LATENCY_INPUT_TO_FRAME, LATENCY_TURN, LATENCY_SAVE, LATENCY_STORE_WRITE, LATENCY_METRICS };
+constexpr const char *LatencyMetricNames[LATENCY_METRICS] = { "input-to-frame", "turn", "save", "store-write" };
+
+// Latency Statistics Struct (One histogram per metric, for a session or everything merged)
+struct LatencyStatistics
+{
+	LatencyHistogram metrics[LATENCY_METRICS];
+
+	void merge(const LatencyStatistics &other)
+	{
+		for (int m = 0; m < LATENCY_METRICS; m++)
+		{
+			metrics[m].merge(other.metrics[m]);
+		}
+	}
+};
+
+// Latency Timer Struct (Records how long the rest of the block took into a histogram)
+struct LatencyTimer
+{
+	LatencyHistogram &histogram;
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+	LatencyTimer(LatencyHistogram &histogram) : histogram(histogram)
+	{
+	}
+
+	~LatencyTimer()
+	{
+		histogram.record(chrono::steady_clock::now() - start);
+	}
+};
+
+// Output Buffer Struct (Collects everything the UI prints into one reusable buffer that is
+// sent with a single write() right before the game waits for input. endl only ends the line
+// here, it never reaches the terminal on its own. With an outbox the frame is handed to it
+// instead, for the server to send when the socket can take it. Headless replays discard it.)
+struct OutputBuffer : public streambuf
+{
+	string bytes;
+	string *outbox = nullptr;
+	bool discard = false;
+	long long frames = 0;
+	long long bytesPresented = 0;
+	long long writeCalls = 0;
+	int lastFrameWrites = 0;
+	int maxFrameWrites = 0;
+	LatencyHistogram *inputToFrame = nullptr;
+	chrono::steady_clock::time_point inputAt{};
+	bool battleFrame = false;
+
+	int_type overflow(int_type c) override
+	{
+		if (!traits_type::eq_int_type(c, traits_type::eof()))
+		{
+			bytes.push_back(traits_type::to_char_type(c));
+		}
+
+		return traits_type::not_eof(c);
+	}
+
+	streamsize xsputn(const char *text, streamsize count) override
+	{
+		bytes.append(text, static_cast<size_t>(count));
+		return count;
+	}
+
+	int sync() override
+	{
+		// Flushing is left to present()
+		return 0;
+	}
+
+	void present()
+	{
+		if (bytes.empty())
+		{
+			return;
+		}
+
+		bytesPresented += bytes.size();
+
+		// Headless, the Frame was only Built to be Timed
+		if (discard)
+		{
+			frameDone();
+			bytes.clear();
+			return;
+		}
+
+		// Queue the Frame for a Session
+		if (outbox != nullptr)
+		{
+			outbox->append(bytes);
+			frameDone();
+			bytes.clear();
+			return;
+		}
+
+		// Send the Frame (Normally in one call, more only if the terminal takes a partial write)
+		int writes = 0;
+		size_t sent = 0;
+
+		while (sent < bytes.size())
+		{
+			writes++;
+#ifdef HAVE_POSIX
+			ssize_t written = ::write(STDOUT_FILENO, bytes.data() + sent, bytes.size() - sent);
+
+			if (written < 0)
+			{
+				if (errno == EINTR)
+				{
+					continue;
+				}
+				break;
+			}
+
+			sent += written;
+#else
+			fwrite(bytes.data() + sent, 1, bytes.size() - sent, stdout);
+			fflush(stdout);
+			sent = bytes.size();
+#endif
+		}
+
+		// Keep Count (Capacity of bytes is kept for the next frame)
+		frameDone();
+		writeCalls += writes;
+		lastFrameWrites = writes;
+		maxFrameWrites = max(maxFrameWrites, writes);
+		bytes.clear();
+	}
+
+	void inputArrived()
+	{
+		inputAt = chrono::steady_clock::now();
+	}
+
+	void frameDone()
+	{
+		frames++;
+
+		// The first Battle Frame after an Input answers it
+		if (battleFrame && inputToFrame != nullptr && inputAt != chrono::steady_clock::time_point{})
+		{
+			inputToFrame->record(chrono::steady_clock::now() - inputAt);
+			inputAt = chrono::steady_clock::time_point{};
+		}
+
+		battleFrame = false;
+	}
+};
+
+// Global Screen Output (Every UI routine writes to screen, the current terminal sends it)
+extern thread_local ostream screen;
+bool showOutputStats = false;
+
+// Character Run Struct (A block of one repeated character, so HP bars and separator lines
+// are written with a single call instead of one stream operation per character)
+struct CharacterRun
+{
+	static const int LENGTH = 256;
+	char text[LENGTH];
+
+	constexpr CharacterRun(char c) : text()
+	{
+		for (int i = 0; i < LENGTH; i++)
+		{
+			text[i] = c;
+		}
+	}
+
+	void write(ostream &out, int count) const
+	{
+		while (count > 0)
+		{
+			int chunk = min(count, LENGTH);
+			out.write(text, chunk);
+			count -= chunk;
+		}
+	}
+};
+
+// Global Character Runs
+constexpr CharacterRun SEPARATOR_RUN('=');
+constexpr CharacterRun HEALTH_RUN('|');
+constexpr CharacterRun LOST_HEALTH_RUN('*');
+
+// Sprite Atlas Struct (pokemon.txt read once into one buffer, every sprite is a range of its lines)
+struct SpriteAtlas
+{
+	const char *data = nullptr;
+	size_t size = 0;
+	string buffer;
+	void *mapping = nullptr;
+	const size_t *lineStart = nullptr;
+	size_t lineCount = 0;
+	vector<size_t> lineIndex;
+
+	void useEmbedded(const char *text, size_t length, const size_t *lines, size_t count)
+	{
+		unload();
 
-	vector<string> icon;
+		// Compiled-in Sprites are already indexed, nothing to read or allocate
+		data = text;
+		size = length;
+		lineStart = lines;
+		lineCount = count;
+	}
 
-	void saveIcon()
+	bool load(const char *path)
 	{
-		// Open File
-		ifstream file("pokemon.txt");
-		string line;
+		unload();
+
+#ifdef HAVE_POSIX
+		// Map the File (No copy, pages come straight from the page cache)
+		int fd = open(path, O_RDONLY);
+		if (fd >= 0)
+		{
+			struct stat info;
+			if (fstat(fd, &info) == 0 && info.st_size > 0)
+			{
+				void *mapped = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+				if (mapped != MAP_FAILED)
+				{
+					mapping = mapped;
+					data = static_cast<const char *>(mapped);
+					size = info.st_size;
+				}
+			}
+			close(fd);
+		}
+#endif
+
+		// Read the Whole File in One Go
+		if (data == nullptr)
+		{
+			ifstream file(path, ios::binary);
+			if (!file)
+			{
+				return false;
+			}
 
-		// Incrementer
-		int i = 0;
+			buffer.assign(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+			data = buffer.data();
+			size = buffer.size();
+		}
 
-		// For Each Line of the File
-		while (getline(file, line))
+		// Index Every Line (lineStart has one extra entry for the end of the last line)
+		lineIndex.push_back(0);
+		for (size_t i = 0; i < size; i++)
 		{
-			// If the line is between the iconBegin and iconEnd
-			if (i >= iconBegin && i < iconEnd)
+			if (data[i] == '\n' && i + 1 < size)
 			{
-				// Push Line onto Vector
-				icon.push_back(line);
+				lineIndex.push_back(i + 1);
 			}
+		}
+		lineIndex.push_back(size);
+
+		lineStart = lineIndex.data();
+		lineCount = lineIndex.size() - 1;
+
+		return true;
+	}
+
+	void unload()
+	{
+#ifdef HAVE_POSIX
+		if (mapping != nullptr)
+		{
+			munmap(mapping, size);
+		}
+#endif
+		mapping = nullptr;
+		data = nullptr;
+		size = 0;
+		buffer.clear();
+		lineIndex.clear();
+		lineStart = nullptr;
+		lineCount = 0;
+	}
+
+	size_t lines() const
+	{
+		return lineCount;
+	}
+
+	// View of lines [first, last) including their line breaks
+	string_view view(int first, int last) const
+	{
+		size_t begin = min(static_cast<size_t>(first), lines());
+		size_t end = min(static_cast<size_t>(last), lines());
 
-			//Increment Line Counter
-			i++;
+		if (begin >= end)
+		{
+			return string_view();
 		}
 
-		// Close File
-		file.close();
+		return string_view(data + lineStart[begin], lineStart[end] - lineStart[begin]);
+	}
+
+	~SpriteAtlas()
+	{
+		unload();
+	}
+};
+
+// Global Sprite Atlas
+SpriteAtlas spriteAtlas;
+
+// Pokemon Data Struct (Contains Species Information)
+struct PokemonSpeciesData
+{
+	const char *Name;
+	int iconBegin;
+	int iconEnd;
+	const char *moveSet[MOVES];
+
+	string_view icon() const
+	{
+		return spriteAtlas.view(iconBegin, iconEnd);
 	}
 
-	void printIcon()
+	void printIcon(ostream &out = screen) const
 	{
-		// Read Everyline from Vector and Print It.
-		for (int i = 0; i < icon.size(); i++)
+		// The Sprite is one contiguous block of the atlas, so print it in one go
+		string_view sprite = icon();
+		out.write(sprite.data(), sprite.size());
+
+		// Last line of the file may not have a line break
+		if (!sprite.empty() && sprite.back() != '\n')
 		{
-			cout << icon.at(i) << endl;
+			out << endl;
 		}
 	}
 };
@@ -96,22 +565,122 @@ struct PokemonSpeciesData
 // Item Data (Contains Information about Items)
 struct PokemonItem
 {
-	string name;
-	string description;
+	const char *name;
+	const char *description;
 	int price;
 };
 
-// Player Pokemon Struct (Contains Information about Pokemon in Player's Possession)
+// Name Table Struct (Interns Pokemon nicknames: every distinct name gets a 32 bit id that stays
+// valid for the whole run. Id 0 is no nickname. Names are only added, under the lock, and an
+// id is only handed out once its name is in place, so looking one up needs no lock. Ids are
+// never reused, so the table has a fixed budget: once it is spent new names are refused and
+// the save that brought them fails to load, rather than the name being dropped.)
+struct NameTable
+{
+	static const uint32_t CHUNK_NAMES = 1024;
+	static const uint32_t MAX_CHUNKS = 256;
+	static const size_t   MAX_BYTES = 16 * 1024 * 1024;
+	static const size_t   NAME_OVERHEAD = 96;
+
+	mutex lock;
+	deque<string> storage;
+	unordered_map<string_view, uint32_t> ids;
+	atomic<string_view *> chunks[MAX_CHUNKS] = {};
+	uint32_t count = 1;
+	size_t bytes = 0;
+
+	// Id of a Name, added if it is new (0 once the table is full)
+	uint32_t intern(string_view name)
+	{
+		lock_guard<mutex> guard(lock);
+
+		auto found = ids.find(name);
+		if (found != ids.end())
+		{
+			return found->second;
+		}
+
+		// Bytes are the Text plus about what the Deque, Map and Chunk keep per Name
+		if (count == CHUNK_NAMES * MAX_CHUNKS || bytes + name.size() + NAME_OVERHEAD > MAX_BYTES)
+		{
+			return 0;
+		}
+
+		uint32_t id = count;
+		string_view *chunk = chunks[id / CHUNK_NAMES].load(memory_order_relaxed);
+		if (chunk == nullptr)
+		{
+			chunk = new string_view[CHUNK_NAMES];
+			chunks[id / CHUNK_NAMES].store(chunk, memory_order_release);
+		}
+
+		// The deque never moves a stored string, so the views stay good
+		const string &stored = storage.emplace_back(name);
+		chunk[id % CHUNK_NAMES] = stored;
+		ids.emplace(stored, id);
+		bytes += name.size() + NAME_OVERHEAD;
+		count++;
+
+		return id;
+	}
+
+	string_view view(uint32_t id) const
+	{
+		return chunks[id / CHUNK_NAMES].load(memory_order_acquire)[id % CHUNK_NAMES];
+	}
+
+	~NameTable()
+	{
+		for (atomic<string_view *> &chunk : chunks)
+		{
+			delete[] chunk.load();
+		}
+	}
+};
+
+NameTable pokemonNames;
+
+// Player Pokemon Struct (Contains Information about Pokemon in Player's Possession. 16 bytes
+// and trivially copyable: the name is the species name unless nickname holds a Name Table id.)
 struct PokemonData
 {
-	string name;
-	int health = 25;
-	int level = 5;
-	int exp = 0;
-	PokemonSpecies species;
+	uint32_t nickname = 0;
+	int32_t exp = 0;
+	uint16_t health = 25;
+	uint16_t maxHealth = 25;
+	uint16_t level = 5;
+	PokemonSpecies species = BULBASAUR;
 	bool isDead = false;
-	int maxHealth = 5 * level;
-	int nextLevelUp = 25 * level;
+
+	string_view name() const
+	{
+		return (nickname != 0) ? pokemonNames.view(nickname) : string_view(DefaultSpeciesNames[species]);
+	}
+
+	// Set the Name (Interned only if it isn't the species name. FAILED, and the name unchanged,
+	// when the Name Table is full.)
+	Status rename(string_view name)
+	{
+		if (name == DefaultSpeciesNames[species])
+		{
+			nickname = 0;
+			return SUCCESS;
+		}
+
+		uint32_t id = pokemonNames.intern(name);
+		if (id == 0)
+		{
+			return FAILED;
+		}
+
+		nickname = id;
+		return SUCCESS;
+	}
+
+	int nextLevelUp() const
+	{
+		return 25 * level;
+	}
 
 	Status takeDamage(int damage)
 	{
@@ -146,13 +715,12 @@ struct PokemonData
 	{
 		exp += incomingEXP;
 
-		if (exp > nextLevelUp)
+		if (exp > nextLevelUp() && level < POKEMON_MAX_LEVEL)
 		{
-			exp -= nextLevelUp;
+			exp -= nextLevelUp();
 
 			level++;
 
-			nextLevelUp = level * 25;
 			health = level * 5;
 			maxHealth = level * 5;
 
@@ -179,8 +747,14 @@ struct PokemonData
 	}
 };
 
-// Global List of Items
-PokemonItem itemData[ITEMS_IN_GAME];
+static_assert(sizeof(PokemonData) == 16 && is_trivially_copyable_v<PokemonData>, "PokemonData is copied as plain bytes");
+
+// Global List of Items (Name, Description and Price)
+constexpr PokemonItem itemData[ITEMS_IN_GAME] =
+{
+	{ "Elixir", "Restores 20 HP to Current Pokemon", 500 },
+	{ "Pokeball", "Used to attempt the capture of a wild Pokemon", 2000 }
+};
 
 // Player Data Struct (Contains Information about the Player)
 struct PlayerData
@@ -274,1364 +848,8335 @@ struct PlayerData
 	}
 };
 
-// Global List of Species Data
-PokemonSpeciesData speciesData[POKEMON_IN_GAME];
+// Global List of Species Data (Name, Icon Line Range in the Sprite Atlas and Special Attacks)
+constexpr PokemonSpeciesData speciesData[POKEMON_IN_GAME] =
+{
+	{ "Bulbasaur",   0,  28,{ "Tackle", "Growl" } },
+	{ "Charmander", 28,  62,{ "Scratch", "Growl" } },
+	{ "Squirtle",   62,  95,{ "Tackle", "Tail Whip" } },
+	{ "Caterpie",   95, 125,{ "Tackle", "String Shot" } },
+	{ "Pidgey",    125, 159,{ "Tackle", "Sand Attack" } },
+	{ "Pikachu",   159, 202,{ "Thunder Shock", "Tail Whip" } },
+	{ "Ekans",     202, 240,{ "Poison Sting", "Bite" } },
+	{ "Oddish",    240, 274,{ "Absorb", "Acid" } },
+	{ "Diglett",   274, 299,{ "Scratch", "Sand Attack" } },
+	{ "Psyduck",   299, 335,{ "Scratch", "Water Gun" } }
+};
 
-// Function Prototypes for Debug Purposes
-void displayData(PlayerData player);
+// Message Ids (Every fixed line of battle, Pokemon Center and Mart text. A binary message
+// starts with one, so the order must stay the same as MessageLayouts below.)
+enum MessageId : uint8_t
+{
+	MESSAGE_BATTLE_START, MESSAGE_WILD_HIT, MESSAGE_WILD_FAINTED, MESSAGE_WILD_MISSED, MESSAGE_ATTACK_HIT, MESSAGE_ATTACK_FAINTED,
+	MESSAGE_ATTACK_MISSED, MESSAGE_ELIXIR_USED, MESSAGE_NO_ITEM, MESSAGE_CAUGHT, MESSAGE_BROKE_FREE, MESSAGE_SWAPPED, MESSAGE_CANNOT_SWAP,
+	MESSAGE_FLED, MESSAGE_CANNOT_FLEE, MESSAGE_VICTORY, MESSAGE_LEVEL_UP, MESSAGE_DEFEAT, MESSAGE_CENTER_ENTRY, MESSAGE_CENTER_HEALED,
+	MESSAGE_CENTER_NO_MONEY, MESSAGE_MART_BOUGHT, MESSAGE_MART_NO_MONEY, MESSAGE_IDS
+};
 
-// Function Prototypes for Helper Functions
-void   clear();
-void   pressEnterToContinue();
-int    getMenuSelection();
-void   drawLines(int lines);
-string multipleStrings(vector<string> statement);
+// Message Slot Kinds (What a placeholder of a Message Template holds: {name} a trainer or
+// Pokemon name, {move} one of a species' moves, {item} an item, {number} an integer)
+enum MessageSlot : uint8_t { SLOT_NAME, SLOT_MOVE, SLOT_ITEM, SLOT_NUMBER };
 
-// Function Prototypes for Initilization Functions
-void initGame();
-void initSpeciesData(PokemonSpeciesData data[POKEMON_IN_GAME]);
-void initItemData(PokemonItem data[ITEMS_IN_GAME]);
+const int    MESSAGE_MAX_SLOTS = 6;
+const size_t MESSAGE_TEXT_CAPACITY = 256;
+const size_t MESSAGE_BINARY_CAPACITY = 512;
 
-// Function Prototypes for Files
-bool gameExists();
-void saveGame(PlayerData player);
-void loadGame(PlayerData &player);
+// Message Layout Struct (A Message Template taken apart at compile time: literal piece i is
+// text[pieceBegin[i], pieceEnd[i]), and slot i goes between pieces i and i + 1)
+struct MessageLayout
+{
+	MessageId id;
+	const char *text;
+	int slotCount;
+	MessageSlot slots[MESSAGE_MAX_SLOTS];
+	uint16_t pieceBegin[MESSAGE_MAX_SLOTS + 1];
+	uint16_t pieceEnd[MESSAGE_MAX_SLOTS + 1];
+
+	string_view piece(int index) const
+	{
+		return string_view(text + pieceBegin[index], pieceEnd[index] - pieceBegin[index]);
+	}
+};
 
-// Function Prototypes for UI Systems
-void getPokemonIcon(PokemonSpecies species);
+// Message Template Struct (A fixed line of text with typed slots, e.g.
+// MessageTemplate<SLOT_NAME, SLOT_NUMBER>{ id, "{name} took {number} damage!" }. The text is
+// checked against the slots when it is compiled: a placeholder that is unknown, out of order or
+// missing is a compile error.)
+template <MessageSlot... Slots>
+struct MessageTemplate
+{
+	static_assert(sizeof...(Slots) <= MESSAGE_MAX_SLOTS, "Too many slots in one message");
 
-void drawHealthUI(int hp, int max);
-void drawBattleUIHeader(PokemonData &attackingPokemon);
-void drawBattleUIFooter(MenuLocation location, PlayerData &trainer);
-void drawBattleUIStatus(PlayerData &trainer, PokemonData &attackingPokemon, string text);
-void drawBattleUI(PlayerData &trainer, PokemonData &attackingPokemon, MenuLocation location, Status &battleStatus);
+	MessageLayout layout;
 
-void battleUIController(PlayerData &trainer, PokemonData &attackingPokemon, MenuLocation &location, int menuSelection, Status &battleStatus);
-void battleUIAttack(PlayerData &trainer, PokemonData &attackingPokemon, Status attackType, Status &battleStatus);
-void battleUIFlee(PlayerData &trainer, PokemonData &attackingPokemon, Status &battleStatus);
+	consteval MessageTemplate(MessageId id, const char *text) : layout{ id, text, sizeof...(Slots), { Slots... }, {}, {} }
+	{
+		string_view format = text;
+		int slot = 0;
+		size_t piece = 0;
 
-// Function Prototypes for Menu Systems
-Status confirmStarterSelection(PlayerData &trainer, int selection);
-void   selectStarterPokemon(PlayerData &trainer);
-void   newGame(PlayerData &trainer);
-void   newGame(PlayerData &trainer);
+		while (true)
+		{
+			layout.pieceBegin[slot] = static_cast<uint16_t>(piece);
 
-// Function Prototypes for Shop Systems
-void   pokemonCenter(PlayerData &trainer);
-int    pokemonCenterCost(int health, int maxHealth);
-Status pokemonCenterHeal(PlayerData &trainer, int pokemonToHeal);
-void   pokemonMart(PlayerData &trainer);
-Status pokemonMartItem(PlayerData &trainer, int item);
+			size_t open = format.find('{', piece);
+			if (open == string_view::npos)
+			{
+				layout.pieceEnd[slot] = static_cast<uint16_t>(format.size());
+				break;
+			}
+			layout.pieceEnd[slot] = static_cast<uint16_t>(open);
 
-// Function Prototypes for Combat Systems
-Status computerAttack(PlayerData &trainer, PokemonData &attackingPokemon, Status &lastAttack);
-void   playerAttack(PlayerData &trainer, PokemonData &attackingPokemon, Status &lastAttack);
-Status throwPokeball(PlayerData &trainer, PokemonData &attackingPokemon, Status &battleStatus);
-Status swapPokemon(PlayerData &trainer, int pokemonToSwap);
-void   deadPickNew(PlayerData &trainer);
-void   playerWin(PlayerData &trainer, PokemonData &attackingPokemon);
-void   computerWin(PlayerData &trainer, PokemonData &attackingPokemon);
-void   pokemonBattleSetup(PlayerData &trainer);
+			size_t close = format.find('}', open);
+			if (close == string_view::npos)
+			{
+				throw "Message template has a { without a }";
+			}
 
-// Function Prototypes for Main Game Loops
-void mainBattleLoop(PlayerData &trainer, PokemonData &attackingPokemon, int whoGoes);
-void mainGameLoop(PlayerData &trainer);
-void mainMenu(PlayerData &trainer);
+			if (slot == layout.slotCount || slotNamed(format.substr(open + 1, close - open - 1)) != layout.slots[slot])
+			{
+				throw "Message template placeholders do not match its slots";
+			}
 
-// *******************************************
-//           main
-//    COMPLETE STARTING POINT
-//********************************************
-int main()
-{
-	// Must Be Called On Initial Load
-	initGame();
+			slot++;
+			piece = close + 1;
+		}
 
-	// Create a PlayerData object
-	PlayerData newPlayer;
+		if (slot != layout.slotCount)
+		{
+			throw "Message template has fewer placeholders than slots";
+		}
+	}
 
-	// Start Game
-	mainMenu(newPlayer);
+	static consteval MessageSlot slotNamed(string_view name)
+	{
+		if (name == "name")   return SLOT_NAME;
+		if (name == "move")   return SLOT_MOVE;
+		if (name == "item")   return SLOT_ITEM;
+		if (name == "number") return SLOT_NUMBER;
 
-	return 0;
-}
-// *******************************************
-//           initGame
-//    Sets EVERYTHING UP
-//********************************************
-void initGame()
+		throw "Unknown message placeholder";
+	}
+};
+
+// Message Move Struct (A {move} slot: which move of which species)
+struct MessageMove
+{
+	PokemonSpecies species;
+	int move;
+};
+
+// Message Value Struct (One filled slot. Names point at the caller's string, moves and items at
+// the game's tables. number is the integer, or the move / item code for the binary form.)
+struct MessageValue
 {
-	// Seed the Pseduo Random Number Generator
-	srand(time(NULL));
+	string_view text;
+	long long number = 0;
+
+	MessageValue() = default;
+	MessageValue(string_view name) : text(name) {}
+	MessageValue(MessageMove move) : text(speciesData[move.species].moveSet[move.move]), number(move.species * MOVES + move.move) {}
+	MessageValue(ItemNames item) : text(itemData[item].name), number(item) {}
+	MessageValue(long long number) : number(number) {}
+};
 
-	// Populate Species Data Array
-	initSpeciesData(speciesData);
+// Message Argument Type (What a caller passes for each kind of slot)
+template <MessageSlot Slot> struct MessageArgument;
+template <> struct MessageArgument<SLOT_NAME> { using type = string_view; };
+template <> struct MessageArgument<SLOT_MOVE> { using type = MessageMove; };
+template <> struct MessageArgument<SLOT_ITEM> { using type = ItemNames; };
+template <> struct MessageArgument<SLOT_NUMBER> { using type = long long; };
 
-	// Populate Item Data Array
-	initItemData(itemData);
-}
-// *******************************************
-//           initSpeciesData
-//    This function initializes the species
-//		information for each specific pokemon
-//		including it's icon line number location
-//		as well as it's special attacks.
-//********************************************
-void initSpeciesData(PokemonSpeciesData data[POKEMON_IN_GAME])
+// Message Struct (One event's message: the template and its filled slots, nothing allocated.
+// The same Message can be written as text or as a binary record, and read back from one.)
+struct Message
 {
-	// Initiate Pokemon Data
-	data[0] = { "Bulbasaur",   0,  28,{ "Tackle", "Growl" } };
-	data[1] = { "Charmander", 28,  62,{ "Scratch", "Growl" } };
-	data[2] = { "Squirtle",   62,  95,{ "Tackle", "Tail Whip" } };
-	data[3] = { "Caterpie",   95, 125,{ "Tackle", "String Shot" } };
-	data[4] = { "Pidgey",    125, 159,{ "Tackle", "Sand Attack" } };
-	data[5] = { "Pikachu",   159, 202,{ "Thunder Shock", "Tail Whip" } };
-	data[6] = { "Ekans",     202, 240,{ "Poison Sting", "Bite" } };
-	data[7] = { "Oddish",    240, 274,{ "Absorb", "Acid" } };
-	data[8] = { "Diglett",   274, 299,{ "Scratch", "Sand Attack" } };
-	data[9] = { "Psyduck",   299, 335,{ "Scratch", "Water Gun" } };
+	const MessageLayout *layout = nullptr;
+	MessageValue values[MESSAGE_MAX_SLOTS];
 
-	// Save Icon Information
-	for (int i = 0; i < POKEMON_IN_GAME; i++)
+	// Text into the caller's buffer (Cut short if it doesn't fit)
+	string_view format(span<char> buffer) const
 	{
-		data[i].saveIcon();
+		char *at = buffer.data();
+		char *end = buffer.data() + buffer.size();
+
+		auto append = [&](string_view piece)
+		{
+			size_t length = min(piece.size(), static_cast<size_t>(end - at));
+			memcpy(at, piece.data(), length);
+			at += length;
+		};
+
+		for (int slot = 0; ; slot++)
+		{
+			append(layout->piece(slot));
+			if (slot == layout->slotCount)
+			{
+				break;
+			}
+
+			if (layout->slots[slot] == SLOT_NUMBER)
+			{
+				at = to_chars(at, end, values[slot].number).ptr;
+			}
+			else
+			{
+				append(values[slot].text);
+			}
+		}
+
+		return string_view(buffer.data(), at - buffer.data());
 	}
-}
-// *******************************************
-//           initItemData
-//    This function initializes the item
-//		information for each specific item
-//		including it's name, description and
-//		as price
-//********************************************
-void initItemData(PokemonItem data[ITEMS_IN_GAME])
-{
-	data[0] = { "Elixir", "Restores 20 HP to Current Pokemon", 500 };
-	data[1] = { "Pokeball", "Used to attempt the capture of a wild Pokemon", 2000 };
-}
-// *******************************************
-//           getPokemonIcon
-//    This function retrieves the pokemon
-//		sprite data and prints it out to the
-//    console.
-//********************************************
-void getPokemonIcon(PokemonSpecies species)
-{
-	PokemonSpeciesData selectedPokemon = speciesData[species];
-	selectedPokemon.printIcon();
-}
-// *******************************************
-//           displayData
-//    Displays Player Data to Console (Debug)
-//********************************************
-void displayData(PlayerData player)
-{
-	cout << player.name << endl;
-	cout << player.rivalName << endl;
-	cout << player.money << endl;
-	cout << player.pokemonOwned << endl << endl;
 
-	// Item Information
-	for (int i = 0; i < ITEMS_IN_GAME; i++)
+	// Binary Record into the caller's buffer: id, then every slot in order. Names are a length
+	// byte and the bytes, moves and items one code byte, numbers zigzag varints. 0 if it doesn't fit.
+	size_t encode(span<uint8_t> buffer) const
 	{
-		cout << itemData[i].name << " : " << player.itemsOwned[i] << endl;
-	}
+		size_t at = 0;
+		bool fits = true;
 
-	cout << endl;
+		auto put = [&](uint8_t byte)
+		{
+			if (at < buffer.size())
+			{
+				buffer[at++] = byte;
+			}
+			else
+			{
+				fits = false;
+			}
+		};
 
-	// Pokemon Information
-	for (int i = 0; i < player.pokemonOwned; i++)
-	{
-		cout << player.pokemon[i].name << endl;
-		cout << player.pokemon[i].health << endl;
-		cout << player.pokemon[i].level << endl;
-		cout << player.pokemon[i].exp << endl;
-		cout << player.pokemon[i].species << endl;
-		cout << player.pokemon[i].isDead << endl;
-		cout << player.pokemon[i].maxHealth << endl;
-		getPokemonIcon(player.pokemon[i].species);
-		cout << endl;
+		put(layout->id);
+		for (int slot = 0; slot < layout->slotCount; slot++)
+		{
+			const MessageValue &value = values[slot];
+			switch (layout->slots[slot])
+			{
+			case SLOT_NAME:
+			{
+				size_t length = min(value.text.size(), static_cast<size_t>(255));
+				put(static_cast<uint8_t>(length));
+				for (size_t i = 0; i < length; i++)
+				{
+					put(static_cast<uint8_t>(value.text[i]));
+				}
+				break;
+			}
+			case SLOT_MOVE:
+			case SLOT_ITEM:
+				put(static_cast<uint8_t>(value.number));
+				break;
+			case SLOT_NUMBER:
+			{
+				uint64_t zigzag = (static_cast<uint64_t>(value.number) << 1) ^ static_cast<uint64_t>(value.number >> 63);
+				do
+				{
+					put(static_cast<uint8_t>((zigzag & 0x7F) | ((zigzag > 0x7F) ? 0x80 : 0)));
+					zigzag >>= 7;
+				} while (zigzag > 0);
+				break;
+			}
+			}
+		}
+
+		return fits ? at : 0;
 	}
-}
+};
+
 // *******************************************
-//           saveGame
-//    Writes Player Data to File
+//           makeMessage
+//    Fills a template's slots. The argument
+//    types come from the template, so a slot
+//    given the wrong kind doesn't compile.
 //********************************************
-void saveGame(PlayerData player)
+template <MessageSlot... Slots>
+Message makeMessage(const MessageTemplate<Slots...> &message, typename MessageArgument<Slots>::type... arguments)
 {
-	// Open Save File
-	ofstream saveFile;
-	saveFile.open("save.txt", ios::out);
+	return Message{ &message.layout, { MessageValue(arguments)... } };
+}
 
-	// Save Trainer Data
-	saveFile << player.name << endl;
-	saveFile << player.rivalName << endl;
-	saveFile << player.money << endl;
-	saveFile << player.pokemonOwned << endl;
+// Battle Messages
+constexpr MessageTemplate<SLOT_NAME, SLOT_NAME>                         BattleStartMessage{ MESSAGE_BATTLE_START, "A wild {name} appeared! GO! {name}!" };
+constexpr MessageTemplate<SLOT_NAME, SLOT_MOVE, SLOT_NAME, SLOT_NUMBER> WildHitMessage{ MESSAGE_WILD_HIT, "Wild {name} used {move}! {name} took {number} damage!" };
+constexpr MessageTemplate<SLOT_NAME, SLOT_MOVE, SLOT_NAME>              WildFaintedMessage{ MESSAGE_WILD_FAINTED, "Wild {name} used {move}! {name} has fainted!" };
+constexpr MessageTemplate<SLOT_NAME, SLOT_MOVE>                         WildMissedMessage{ MESSAGE_WILD_MISSED, "Wild {name} used {move}!  It missed!" };
+constexpr MessageTemplate<SLOT_NAME, SLOT_MOVE, SLOT_NAME, SLOT_NUMBER> AttackHitMessage{ MESSAGE_ATTACK_HIT, "{name} used {move}! Wild {name} took {number} damage!" };
+constexpr MessageTemplate<SLOT_NAME, SLOT_MOVE, SLOT_NAME>              AttackFaintedMessage{ MESSAGE_ATTACK_FAINTED, "{name} used {move}! Wild {name} has fainted!" };
+constexpr MessageTemplate<SLOT_NAME, SLOT_MOVE>                         AttackMissedMessage{ MESSAGE_ATTACK_MISSED, "{name} used {move}!  It missed!" };
+constexpr MessageTemplate<SLOT_NUMBER, SLOT_NAME>                       ElixirUsedMessage{ MESSAGE_ELIXIR_USED, "Added {number} HP to {name}!" };
+constexpr MessageTemplate<>                                             NoItemMessage{ MESSAGE_NO_ITEM, "You do not have any of that item." };
+constexpr MessageTemplate<SLOT_NAME, SLOT_NAME>                         CaughtMessage{ MESSAGE_CAUGHT, "{name} used a POKEBALL! GOTCHA! Wild {name} was caught!" };
+constexpr MessageTemplate<SLOT_NAME>                                    BrokeFreeMessage{ MESSAGE_BROKE_FREE, "{name} used a POKEBALL! Oh, no! The POKEMON broke free!" };
+constexpr MessageTemplate<SLOT_NAME, SLOT_NAME>                         SwappedMessage{ MESSAGE_SWAPPED, "{name} come back! Go! {name}!" };
+constexpr MessageTemplate<>                                             CannotSwapMessage{ MESSAGE_CANNOT_SWAP, "This POKEMON is not fit for battle! Cannot swap!" };
+constexpr MessageTemplate<>                                             FledMessage{ MESSAGE_FLED, "Got away safely!" };
+constexpr MessageTemplate<>                                             CannotFleeMessage{ MESSAGE_CANNOT_FLEE, "Can't Escape!" };
+constexpr MessageTemplate<SLOT_NAME, SLOT_NAME, SLOT_NAME, SLOT_NUMBER, SLOT_NAME, SLOT_NUMBER>
+	VictoryMessage{ MESSAGE_VICTORY, "{name} has defeated {name}! {name} has earned {number} EXP! \n{name} has earned {number} credits!" };
+constexpr MessageTemplate<SLOT_NAME, SLOT_NUMBER>                       LevelUpMessage{ MESSAGE_LEVEL_UP, "{name} has leveled up to Level {number}!" };
+constexpr MessageTemplate<SLOT_NAME, SLOT_NAME, SLOT_NAME, SLOT_NUMBER>  DefeatMessage{ MESSAGE_DEFEAT, "{name} has been defeated by {name}! {name} has lost {number} credits." };
+
+// Pokemon Center and Mart Messages
+constexpr MessageTemplate<SLOT_NUMBER, SLOT_NAME, SLOT_NUMBER, SLOT_NUMBER> CenterEntryMessage{ MESSAGE_CENTER_ENTRY, "{number}. {name} ( {number} HP / {number} HP )" };
+constexpr MessageTemplate<SLOT_NAME>                                    CenterHealedMessage{ MESSAGE_CENTER_HEALED, "Success! You have healed {name} to full health!" };
+constexpr MessageTemplate<SLOT_NAME>                                    CenterNoMoneyMessage{ MESSAGE_CENTER_NO_MONEY, "You do not have enough money to heal {name}. Come back when you have the money." };
+constexpr MessageTemplate<SLOT_ITEM>                                    MartBoughtMessage{ MESSAGE_MART_BOUGHT, "You have successfully purchased a {item}." };
+constexpr MessageTemplate<SLOT_ITEM>                                    MartNoMoneyMessage{ MESSAGE_MART_NO_MONEY, "You do not have enough money to purchase a {item}." };
+
+// Global List of Message Layouts by Id (What a binary record's id byte is read back with)
+constexpr const MessageLayout *MessageLayouts[MESSAGE_IDS] =
+{
+	&BattleStartMessage.layout, &WildHitMessage.layout, &WildFaintedMessage.layout, &WildMissedMessage.layout, &AttackHitMessage.layout,
+	&AttackFaintedMessage.layout, &AttackMissedMessage.layout, &ElixirUsedMessage.layout, &NoItemMessage.layout, &CaughtMessage.layout,
+	&BrokeFreeMessage.layout, &SwappedMessage.layout, &CannotSwapMessage.layout, &FledMessage.layout, &CannotFleeMessage.layout,
+	&VictoryMessage.layout, &LevelUpMessage.layout, &DefeatMessage.layout, &CenterEntryMessage.layout, &CenterHealedMessage.layout,
+	&CenterNoMoneyMessage.layout, &MartBoughtMessage.layout, &MartNoMoneyMessage.layout
+};
 
-	// Save Owned Item Amount Information
-	for (int i = 0; i < ITEMS_IN_GAME; i++)
+static_assert([]
+{
+	for (int i = 0; i < MESSAGE_IDS; i++)
 	{
-		saveFile << player.itemsOwned[i];
-
-		// Do we put a space in the line?
-		if (i < ITEMS_IN_GAME - 1)
+		if (MessageLayouts[i]->id != i)
 		{
-			saveFile << " ";
+			return false;
 		}
 	}
+	return true;
+}(), "MessageLayouts must be in MessageId order");
+
+// Save File Format (save.dat, all numbers little endian)
+//
+//    Header   32 bytes   magic "PKSV", version, oldest reader version that can load it,
+//                        header size, payload length, CRC32C, record sizes and counts
+//    Trainer  fixed      name / rival (offset + length into the string area), money,
+//                        pokemon owned
+//    Items    4 bytes    quantity per item
+//    Pokemon  fixed      name (offset + length), health, level, exp, max health,
+//                        species, dead flag
+//    Strings             every name, back to back
+//
+// Newer versions may only grow records or the header at the end and raise version. Older
+// readers skip what they don't know. A change older readers can't skip must raise
+// compatVersion, which makes them refuse the file instead of misreading it.
+const char     SAVE_FILE[] = "save.dat";
+const char     LEGACY_SAVE_FILE[] = "save.txt";
+const char     SAVE_MAGIC[4] = { 'P', 'K', 'S', 'V' };
+const uint16_t SAVE_VERSION = 1;
+const uint16_t SAVE_HEADER_SIZE = 32;
+const uint16_t SAVE_TRAINER_RECORD_SIZE = 24;
+const uint16_t SAVE_POKEMON_RECORD_SIZE = 28;
+
+// Save Journal Format (Frames appended after a snapshot, see the Trainer Store below)
+//
+//    Frames              record length, records, CRC32C of both. One frame per save.
+//    Record   6 bytes    type, party slot / item, new value
+//    Caught              type, party slot, species, name length, name
+//
+// Replay stops at the first frame that is torn or fails its checksum. The save.journal
+// file written next to save.dat by older versions (12 byte header: magic "PKJL", version,
+// checksum of the save.dat it continues) is only read to import it into the store.
+const char     SAVE_JOURNAL_FILE[] = "save.journal";
+const char     SAVE_JOURNAL_MAGIC[4] = { 'P', 'K', 'J', 'L' };
+const uint32_t SAVE_JOURNAL_HEADER_SIZE = 12;
+const size_t   SAVE_JOURNAL_LIMIT = 4096;
+
+enum JournalRecordType { JOURNAL_MONEY, JOURNAL_ITEM, JOURNAL_CAUGHT, JOURNAL_HEALTH, JOURNAL_LEVEL, JOURNAL_EXP, JOURNAL_MAX_HEALTH, JOURNAL_DEAD };
+
+// Save Header Struct (Decoded copy of the 32 header bytes)
+struct SaveHeader
+{
+	char     magic[4] = {};
+	uint16_t version = 0;
+	uint16_t compatVersion = 0;
+	uint32_t headerSize = 0;
+	uint32_t payloadLength = 0;
+	uint32_t checksum = 0;
+	uint16_t trainerRecordSize = 0;
+	uint16_t pokemonRecordSize = 0;
+	uint16_t itemCount = 0;
+	uint16_t pokemonCount = 0;
+	uint32_t stringsLength = 0;
+};
 
-	// New Line (To Seperate)
-	saveFile << endl;
+// Save Writer Struct (Appends fixed width little endian fields to a byte buffer)
+struct SaveWriter
+{
+	string bytes;
 
-	// Save Owned Pokemon Data
-	for (int i = 0; i < player.pokemonOwned; i++)
+	void u8(uint8_t value)
 	{
-		saveFile << player.pokemon[i].name << endl;
-		saveFile << player.pokemon[i].health << endl;
-		saveFile << player.pokemon[i].level << endl;
-		saveFile << player.pokemon[i].exp << endl;
-		saveFile << player.pokemon[i].species << endl;
-		saveFile << player.pokemon[i].isDead << endl;
-		saveFile << player.pokemon[i].maxHealth << endl;
+		bytes.push_back(static_cast<char>(value));
 	}
 
-	// Close Save File
-	saveFile.close();
-}
-// *******************************************
-//           loadGame
-//    Read Player Data from File
-//********************************************
-void loadGame(PlayerData &player)
-{
-	// Constant Values
-	const int PLAYER_LINES = 5;
-	const int POKEMON_LINES = 7;
-
-	// Open Save File
-	ifstream saveFile;
-	saveFile.open("save.txt");
+	void u16(uint16_t value)
+	{
+		u8(static_cast<uint8_t>(value));
+		u8(static_cast<uint8_t>(value >> 8));
+	}
 
-	// Container for Line Information
-	string line;
+	void u32(uint32_t value)
+	{
+		u16(static_cast<uint16_t>(value));
+		u16(static_cast<uint16_t>(value >> 16));
+	}
 
-	// Line Incrementers
-	int lineNumber = 0;
-	int pokemonRead = 0;
-	int pokemonLineInc = 0;
+	void i32(int32_t value)
+	{
+		u32(static_cast<uint32_t>(value));
+	}
 
-	// For Each Line
-	while (getline(saveFile, line))
+	void patch32(size_t at, uint32_t value)
 	{
-		// Trainer Data
-		if (lineNumber < PLAYER_LINES)
+		for (int i = 0; i < 4; i++)
 		{
-			switch (lineNumber)
-			{
-			case 0:
-				// Get Player Name
-				player.name = line;
-				break;
-			case 1:
-				// Get Rival Name
-				player.rivalName = line;
-				break;
-			case 2:
-				// Get Money
-				player.money = stoi(line);
-				break;
-			case 3:
-				// Get Number of Pokemon Owned
-				player.pokemonOwned = stoi(line);
-				break;
-			case 4:
-				// Get Item Quantities Owned
-
-				// Create StringStream with Buffer (This splits the line by spaces)
-				string buffer;
-				stringstream ss(line);
-
-				// Incrementer
-				int i = 0;
-
-				// For Each Value
-				while (ss >> buffer)
-				{
-					// Get Item Quantity
-					int itemQuantity = stoi(buffer);
-
-					/// Add Item (i = ItemNames) to Player * Quantity
-					for (int q = 0; q < itemQuantity; q++)
-					{
-						player.itemsOwned[i] = itemQuantity;
-					}
-
-					// Increment to Next Item
-					i++;
-				}
-				break;
-			}
+			bytes[at + i] = static_cast<char>(value >> (8 * i));
 		}
+	}
+};
 
-		// Pokemon Data
-		if (player.pokemonOwned > 0 && lineNumber > 4)
-		{
-			switch (pokemonLineInc)
-			{
-			case 0:
-				// Get Pokemon Name
-				player.pokemon[pokemonRead].name = line;
-				break;
-			case 1:
-				// Get Pokemon Health
-				player.pokemon[pokemonRead].health = stoi(line);
-				break;
-			case 2:
-				// Get Pokemon Level
-				player.pokemon[pokemonRead].level = stoi(line);
-				break;
-			case 3:
-				// Get Pokemon Experience Points
-				player.pokemon[pokemonRead].exp = stoi(line);
-				break;
-			case 4:
-				// Get Pokemon Species ENUM
-				player.pokemon[pokemonRead].species = static_cast<PokemonSpecies>(stoi(line));
-				break;
-			case 5:
-				// Get Pokemon Dead Status
-				player.pokemon[pokemonRead].isDead = static_cast<bool>(stoi(line));
-				break;
-			case 6:
-				// Get Pokemon Max Health Value
-				player.pokemon[pokemonRead].maxHealth = stoi(line);
-			}
+// Save Reader Struct (Reads fixed width little endian fields at a given offset)
+struct SaveReader
+{
+	const unsigned char *data;
+	size_t size;
 
-			// Increment Individual Pokemon Data Counter
-			++pokemonLineInc;
+	SaveReader(const string &bytes) : data(reinterpret_cast<const unsigned char *>(bytes.data())), size(bytes.size())
+	{
+	}
 
-			// If the current pokemon line is at the end point, reset line counter and read in the next pokemon.
-			if (pokemonLineInc == POKEMON_LINES)
-			{
-				pokemonLineInc = 0;
-				pokemonRead++;
-			}
-		}
+	uint8_t u8(size_t at) const
+	{
+		return data[at];
+	}
 
-		// Increment Line Counter
-		lineNumber++;
+	uint16_t u16(size_t at) const
+	{
+		return static_cast<uint16_t>(data[at] | (data[at + 1] << 8));
 	}
 
-	// Close Save File
-	saveFile.close();
-}
-// *******************************************
-//           drawHealthUI
-//    Draws Health as | and *'s
-//********************************************
-void drawHealthUI(int hp, int max)
-{
-	// Draw Current HP Bars
-	for (int i = 0; i < hp; i++)
+	uint32_t u32(size_t at) const
 	{
-		cout << "|";
+		return static_cast<uint32_t>(u16(at)) | (static_cast<uint32_t>(u16(at + 2)) << 16);
 	}
 
-	int starsToDraw = max - hp;
+	int32_t i32(size_t at) const
+	{
+		return static_cast<int32_t>(u32(at));
+	}
 
-	// Draw HP Lost Stars
-	for (int i = 0; i < starsToDraw; i++)
+	bool text(size_t areaStart, size_t areaLength, uint32_t offset, uint32_t length, string &out) const
 	{
-		cout << "*";
+		if (offset > areaLength || length > areaLength - offset)
+		{
+			return false;
+		}
+
+		out.assign(reinterpret_cast<const char *>(data) + areaStart + offset, length);
+		return true;
 	}
-}
-// *******************************************
-//           drawBattleUIHeader
-//    Draws Top Portion of Battle UI System
-//    This displays the name and health of the
-//    opponent.
-//********************************************
-void drawBattleUIHeader(PokemonData &attackingPokemon)
-{
-	// Draw First Line (60 Characters)
-	drawLines(60);
 
-	// Draw Attacking Pokemon Information
-	cout << "= Target Name: " << attackingPokemon.name << endl;
-	cout << "= Target Level: " << attackingPokemon.level << endl;
+	bool text(size_t areaStart, size_t areaLength, uint32_t offset, uint32_t length, string_view &out) const
+	{
+		if (offset > areaLength || length > areaLength - offset)
+		{
+			return false;
+		}
 
-	cout << "= Target HP: ";
-	drawHealthUI(attackingPokemon.health, attackingPokemon.maxHealth);
-	cout << " (" << attackingPokemon.health << " HP / " << attackingPokemon.maxHealth << " HP) " << endl;
+		out = string_view(reinterpret_cast<const char *>(data) + areaStart + offset, length);
+		return true;
+	}
+};
 
-	// Draw Last Line (60 Characters)
-	drawLines(60);
-}
-// *******************************************
-//           drawBattleUIFooter
-//    Draws Bottom Portion of Battle UI System
-//    Several Menu Systems are handled here.
-//    Allows the user to select to attack, bag
-//    swap out their pokemon, and attempt to
-//    flee
-//********************************************
-void drawBattleUIFooter(MenuLocation location, PlayerData &trainer)
+// CRC-32C Table Struct (Lookup table for the save checksum, built at compile time)
+struct Crc32cTable
 {
-	// Draw First Line (60 Characters)
-	drawLines(60);
+	uint32_t entry[256];
 
-	if (location == ATTACK)
+	constexpr Crc32cTable() : entry()
 	{
-		// Get Species Information of currently active trainer Pokemon
-		PokemonData trainersPokemon = trainer.pokemon[0];
-		PokemonSpecies trainerPokemonSpecies = trainersPokemon.species;
-		PokemonSpeciesData pokemonSpecies = speciesData[trainerPokemonSpecies];
-
-		// Assemble Menu Items
-		string attack1 = "1. ";
-		attack1.append(pokemonSpecies.moveSet[0]);
+		for (uint32_t i = 0; i < 256; i++)
+		{
+			uint32_t value = i;
 
-		string attack2 = "2. ";
-		attack2.append(pokemonSpecies.moveSet[1]);
+			for (int bit = 0; bit < 8; bit++)
+			{
+				value = (value & 1) ? (value >> 1) ^ 0x82F63B78u : (value >> 1);
+			}
 
-		string back = "3. Previous Menu";
+			entry[i] = value;
+		}
+	}
+};
 
-		// Assemble Right Hand Side Stats about currently active trainer Pokemon
-		string trainerPokemonName = "= Name:  ";
-		trainerPokemonName.append(trainersPokemon.name);
+// Global CRC-32C Table
+constexpr Crc32cTable CRC32C_TABLE;
 
-		string trainerPokemonLevel = "= Level: ";
-		trainerPokemonLevel.append(to_string(trainersPokemon.level));
+// Legacy Parse Error Struct (Where save.txt parsing stopped and why. message is a literal, so
+// reporting an error allocates nothing.)
+struct LegacyParseError
+{
+	size_t offset = 0;
+	int line = 0;
+	const char *message = nullptr;
+};
 
-		string trainerPokemonHP = "= HP:    ";
-		trainerPokemonHP.append(to_string(trainersPokemon.health));
-		trainerPokemonHP.append(" HP / ");
-		trainerPokemonHP.append(to_string(trainersPokemon.maxHealth));
-		trainerPokemonHP.append(" HP");
+// Legacy Reader Struct (A cursor over the text of a save.txt. Names come out as views into the
+// text and numbers are parsed in place with from_chars, each line in a single pass.)
+struct LegacyReader
+{
+	string_view text;
+	size_t at = 0;
+	int line = 1;
 
-		// Output Information to Screen
-		cout << left;
-		cout << setw(20) << "Select Attack: " << setw(20) << "= Player Pokemon Stats:" << endl;
-		cout << setw(20) << attack1 << setw(20) << "=" << endl;
-		cout << setw(20) << attack2 << setw(20) << trainerPokemonName << endl;
-		cout << right << setfill(' ') << setw(30) << trainerPokemonLevel << endl;
-		cout << left << setw(20) << back << setw(20) << trainerPokemonHP << endl;
+	LegacyReader(string_view source) : text(source)
+	{
 	}
-	else if (location == BAG)
+
+	// The rest of the current line (without the line break or a Windows \r)
+	bool name(string_view &out, LegacyParseError &error)
 	{
-		// Print Trainer's Name
-		cout << trainer.name << "'s Bag:" << endl << endl;
+		if (at >= text.size())
+		{
+			return fail(error, "file ends early");
+		}
 
-		// If the user has a ELIXIR in their inventory, show this as a selectable option.
-		if (trainer.itemsOwned[ELIXIR] > 0)
+		size_t end = text.find('\n', at);
+		if (end == string_view::npos)
 		{
-			cout << "1. Elixir   (Quantity: " << trainer.itemsOwned[ELIXIR] << ") " << endl;
+			end = text.size();
 		}
 
-		// If the user has a POKEBALL in their inventory, show this as a selectable option.
-		if (trainer.itemsOwned[POKEBALL] > 0)
+		out = text.substr(at, end - at);
+		if (!out.empty() && out.back() == '\r')
 		{
-			cout << "2. Pokeball (Quantity: " << trainer.itemsOwned[POKEBALL] << ") " << endl;
+			out.remove_suffix(1);
 		}
 
-		// Print End of Menu
-		cout << endl;
-		cout << "3. Previous Menu" << endl;
+		at = end;
+		return endLine(error);
 	}
-	else if (location == SELECTION)
+
+	// A whole number in [low, high] at the cursor
+	bool number(int low, int high, const char *what, int &value, LegacyParseError &error)
 	{
-		// Print Trainer's Name
-		cout << trainer.name << "'s Pokemon: " << endl;
-		cout << endl;
+		if (at >= text.size())
+		{
+			return fail(error, "file ends early");
+		}
 
-		// Display All Pokemon in Trainer's Inventory
-		for (int i = 0; i < trainer.pokemonOwned; i++)
+		int parsed = 0;
+		from_chars_result result = from_chars(text.data() + at, text.data() + text.size(), parsed);
+
+		if (result.ec != errc() || parsed < low || parsed > high)
 		{
-			cout << i + 1 << ". " << left << setfill(' ') << setw(15) << trainer.pokemon[i].name;
-			cout << " LV: " << trainer.pokemon[i].level;
-			cout << " HP: " << trainer.pokemon[i].health;
-			cout << " HP / " << trainer.pokemon[i].maxHealth << " HP" << endl;
+			return fail(error, what, at);
 		}
 
-		// Finish End of Menu
-		cout << endl;
-		cout << "7. Previous Menu" << endl;
+		at = result.ptr - text.data();
+		value = parsed;
+		return true;
 	}
-	else
+
+	void skipSpaces()
 	{
-		// Display Main Menu Screen
-		cout << "=== 1. Attack == == 2. Bag == == 3. Pokemon == == 4. Flee ==" << endl;
+		while (at < text.size() && text[at] == ' ')
+		{
+			at++;
+		}
+	}
+
+	// The line must end here
+	bool endLine(LegacyParseError &error, const char *what = "unexpected data at the end of the line")
+	{
+		if (at < text.size() && text[at] == '\r')
+		{
+			at++;
+		}
+
+		if (at < text.size() && text[at] != '\n')
+		{
+			return fail(error, what, at);
+		}
+
+		at = min(at + 1, text.size());
+		line++;
+		return true;
+	}
+
+	// Reports an error on the current line (at the end of the text if offset isn't given)
+	bool fail(LegacyParseError &error, const char *message, size_t offset = string_view::npos) const
+	{
+		error.offset = (offset == string_view::npos) ? text.size() : offset;
+		error.line = line;
+		error.message = message;
+		return false;
+	}
+};
+
+// Save Statistics (How long the last save and load took, shown by --output-stats)
+struct SaveStatistics
+{
+	long long saves = 0;
+	long long loads = 0;
+	long long lastSaveMicros = 0;
+	long long lastLoadMicros = 0;
+	size_t lastSaveBytes = 0;
+	long long journalAppends = 0;
+	long long compactions = 0;
+	LatencyHistogram saveLatency;
+	LatencyHistogram storeWriteLatency;
+};
+
+// Global Save Statistics
+SaveStatistics saveStats;
+
+// Latency Objective Struct (--slo METRIC:PERCENTILE:MICROSECONDS, e.g. input-to-frame:99.9:500
+// asks for 99.9% of inputs to be answered with a battle frame within 500 us)
+struct LatencyObjective
+{
+	LatencyMetric metric = LATENCY_INPUT_TO_FRAME;
+	double percentile = 99;
+	double limitMicros = 0;
+};
+
+// Global Latency Objectives (Checked when the game, a replay or the server ends)
+vector<LatencyObjective> latencyObjectives;
+
+// Trainer Store Format (trainers.db, every trainer in one file of fixed size pages)
+//
+//    Page 0              magic "PKDB", version, page size, page count, trainer count,
+//                        bucket count, first index page, free list head, CRC32C
+//    Index pages         open addressing hash table, 32 byte buckets: name hash, first
+//                        page of the record, name length and the first 19 name characters
+//    Record pages        next page, bytes used, then data. A record is a save.dat
+//                        snapshot followed by journal frames, spread over a page chain.
+//    Free pages          chained through their next page field, reused before the file grows
+//
+// Saves append a journal frame to the last page of the chain. Compaction writes a new
+// chain, points the bucket at it and only then frees the old one, so a crash at any point
+// leaves every trainer readable (at worst a few pages are never reused).
+const char     STORE_FILE[] = "trainers.db";
+const char     STORE_MAGIC[4] = { 'P', 'K', 'D', 'B' };
+const uint16_t STORE_VERSION = 1;
+const uint32_t STORE_PAGE_SIZE = 512;
+const uint32_t STORE_PAGE_HEADER_SIZE = 8;
+const uint32_t STORE_PAGE_DATA_SIZE = STORE_PAGE_SIZE - STORE_PAGE_HEADER_SIZE;
+const uint32_t STORE_BUCKET_SIZE = 32;
+const uint32_t STORE_BUCKETS_PER_PAGE = STORE_PAGE_SIZE / STORE_BUCKET_SIZE;
+const uint32_t STORE_NAME_PREFIX = 19;
+const uint32_t STORE_INITIAL_BUCKETS = 64;
+
+// Store Entry Struct (One bucket of the index, as shown in the trainer list)
+struct StoreEntry
+{
+	uint32_t bucket = 0;
+	uint32_t firstPage = 0;
+	uint64_t hash = 0;
+	string name;
+	bool partialName = false;
+};
+
+// Store Slot Struct (What the store holds for one trainer, so the next save only has to append
+// the difference. Kept by whoever holds the trainer, see the Trainer Cache.)
+struct StoreSlot
+{
+	bool known = false;
+	PlayerData saved;
+	uint32_t bucket = 0;
+	uint32_t firstPage = 0;
+	uint32_t lastPage = 0;
+	uint32_t lastUsed = 0;
+	size_t journalBytes = 0;
+	bool needsCompaction = false;
+};
+
+// Trainer Store Struct (Open trainers.db and its header)
+struct TrainerStore
+{
+	mutex lock;
+#ifdef HAVE_POSIX
+	int file = -1;
+#else
+	fstream file;
+#endif
+	bool isOpen = false;
+	uint32_t pageCount = 0;
+	uint32_t trainerCount = 0;
+	uint32_t bucketCount = 0;
+	uint32_t indexPage = 0;
+	uint32_t freeHead = 0;
+
+	bool readAt(uint64_t offset, void *data, size_t size)
+	{
+#ifdef HAVE_POSIX
+		return pread(file, data, size, static_cast<off_t>(offset)) == static_cast<ssize_t>(size);
+#else
+		file.clear();
+		file.seekg(offset);
+		file.read(static_cast<char *>(data), size);
+		return static_cast<bool>(file);
+#endif
+	}
+
+	uint64_t size()
+	{
+#ifdef HAVE_POSIX
+		struct stat info;
+		return fstat(file, &info) == 0 ? static_cast<uint64_t>(info.st_size) : 0;
+#else
+		file.clear();
+		file.seekg(0, ios::end);
+		streamoff end = file.tellg();
+		return end > 0 ? static_cast<uint64_t>(end) : 0;
+#endif
+	}
+
+	bool writeAt(uint64_t offset, const void *data, size_t size)
+	{
+#ifdef HAVE_POSIX
+		return pwrite(file, data, size, static_cast<off_t>(offset)) == static_cast<ssize_t>(size);
+#else
+		file.clear();
+		file.seekp(offset);
+		file.write(static_cast<const char *>(data), size);
+		return static_cast<bool>(file.flush());
+#endif
+	}
+
+	uint64_t pageOffset(uint32_t page) const
+	{
+		return static_cast<uint64_t>(page) * STORE_PAGE_SIZE;
+	}
+
+	uint64_t bucketOffset(uint32_t bucket) const
+	{
+		return pageOffset(indexPage + bucket / STORE_BUCKETS_PER_PAGE) + (bucket % STORE_BUCKETS_PER_PAGE) * STORE_BUCKET_SIZE;
+	}
+
+	~TrainerStore()
+	{
+#ifdef HAVE_POSIX
+		if (file >= 0)
+		{
+			close(file);
+		}
+#endif
+	}
+};
+
+// Global Store Path (--store PATH)
+const char *storePath = STORE_FILE;
+
+// Global Trainer Store
+TrainerStore trainerStore;
+
+// Trainer Cache Struct (A fixed number of live trainers kept in memory over the Trainer Store)
+// Saves only update the cached copy and mark it dirty. Dirty trainers are written to the store
+// by writeBack (every few seconds from the Save Worker, and on flush) or when CLOCK picks
+// them to make room: the hand sweeps the entries, clearing the referenced bit of recently
+// used ones, and evicts the first entry it finds unreferenced.
+struct TrainerCache
+{
+	struct Entry
+	{
+		PlayerData current;
+		StoreSlot slot;
+		bool used = false;
+		bool dirty = false;
+		bool referenced = false;
+	};
+
+	mutex lock;
+	vector<Entry> entries;
+	unordered_map<string, int> index;
+	int hand = 0;
+	long long hits = 0;
+	long long misses = 0;
+	long long evictions = 0;
+	long long writeBacks = 0;
+	long long writeFailures = 0;
+
+	TrainerCache(int capacity)
+	{
+		resize(capacity);
+	}
+
+	void resize(int capacity)
+	{
+		entries.assign(max(1, capacity), Entry());
+		index.clear();
+		index.reserve(entries.size());
+		hand = 0;
+	}
+};
+
+// Global Trainer Cache
+const int TRAINER_CACHE_CAPACITY = 1024;
+const int TRAINER_CACHE_WRITE_BACK_SECONDS = 5;
+TrainerCache trainerCache(TRAINER_CACHE_CAPACITY);
+
+// Screen Buffer Struct (The Battle UI draws a whole frame into the canvas, then only the
+// rows and columns that differ from what is already on the terminal are sent, using ANSI
+// cursor addressing. Anything else that writes to the terminal must call invalidate().)
+struct ScreenBuffer
+{
+	OutputBuffer canvasBuffer;
+	ostream canvas;
+	vector<string> rows;
+	vector<string> shown;
+	string output;
+	bool valid = false;
+	bool console = true;
+	size_t lastFrameBytes = 0;
+
+	ScreenBuffer() : canvas(&canvasBuffer)
+	{
+	}
+
+	void invalidate()
+	{
+		valid = false;
+	}
+
+	int terminalHeight() const
+	{
+		// Session Screens are never Measured (Clients only get a height by scrolling)
+		if (!console)
+		{
+			return 0;
+		}
+
+#if defined(HAVE_POSIX)
+		struct winsize size;
+		if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) == 0 && size.ws_row > 0)
+		{
+			return size.ws_row;
+		}
+#elif defined(_WIN32)
+		CONSOLE_SCREEN_BUFFER_INFO info;
+		if (GetConsoleScreenBufferInfo(GetStdHandle(STD_OUTPUT_HANDLE), &info))
+		{
+			return info.srWindow.Bottom - info.srWindow.Top + 1;
+		}
+#endif
+		// Not a Terminal (No Scrolling to worry about)
+		return 0;
+	}
+
+	void present(ostream &out)
+	{
+		// Split the Canvas into Rows (Row strings and the canvas keep their capacity between frames)
+		const string &text = canvasBuffer.bytes;
+
+		size_t rowCount = 0;
+		size_t start = 0;
+		while (start < text.size())
+		{
+			size_t end = text.find('\n', start);
+			if (end == string::npos)
+			{
+				end = text.size();
+			}
+
+			// Carriage Returns would move the cursor behind our back
+			size_t length = end - start;
+			if (length > 0 && text[end - 1] == '\r')
+			{
+				length--;
+			}
+
+			if (rowCount == rows.size())
+			{
+				rows.emplace_back();
+			}
+
+			rows[rowCount++].assign(text, start, length);
+			start = end + 1;
+		}
+
+		rows.resize(rowCount);
+		canvasBuffer.bytes.clear();
+
+		// Frames taller than the terminal scroll, so their rows can't be addressed
+		int height = terminalHeight();
+		bool fits = (height == 0 || static_cast<int>(rows.size()) < height);
+
+		output.clear();
+
+		if (!valid || !fits)
+		{
+			// Full Repaint
+			output += "\x1b[H\x1b[2J";
+			for (const string &row : rows)
+			{
+				output += row;
+				output += '\n';
+			}
+		}
+		else
+		{
+			for (size_t r = 0; r < rows.size(); r++)
+			{
+				const string &row = rows[r];
+				const string empty;
+				const string &old = (r < shown.size()) ? shown[r] : empty;
+
+				if (row == old)
+				{
+					continue;
+				}
+
+				// Skip the Matching Start of the Row (only while columns line up with bytes)
+				size_t column = 0;
+				while (column < row.size() && column < old.size() && row[column] == old[column]
+					&& static_cast<unsigned char>(row[column]) >= ' ' && static_cast<unsigned char>(row[column]) < 0x80)
+				{
+					column++;
+				}
+
+				output += "\x1b[" + to_string(r + 1) + ";" + to_string(column + 1) + "H";
+				output.append(row, column, string::npos);
+
+				// Erase what is left of a Longer Old Row
+				if (old.size() > row.size())
+				{
+					output += "\x1b[K";
+				}
+			}
+
+			// Park the Cursor under the Frame and clear anything left below it (old prompts)
+			output += "\x1b[" + to_string(rows.size() + 1) + ";1H\x1b[J";
+		}
+
+		out.write(output.data(), output.size());
+		lastFrameBytes = output.size();
+
+		shown.swap(rows);
+		valid = fits;
+	}
+};
+
+// Input Closed Struct (Thrown out of a Terminal's input once there is no more of it: Ctrl+D, the
+// end of a script or a client that left. The menus unwind the same way they return.)
+struct InputClosed
+{
+};
+
+// Input Source Struct (Where a Terminal's keystrokes come from, one line at a time. The menus
+// read it through an istream, so backends only implement nextLine().)
+struct InputSource : public streambuf
+{
+	string line;
+	long long lines = 0;
+
+	// Next Line without its Newline, false once there are no more
+	virtual bool nextLine(string &text) = 0;
+
+	int_type underflow() override
+	{
+		if (gptr() < egptr())
+		{
+			return traits_type::to_int_type(*gptr());
+		}
+
+		if (!nextLine(line))
+		{
+			throw InputClosed();
+		}
+
+		line.push_back('\n');
+		lines++;
+
+		setg(&line[0], &line[0], &line[0] + line.size());
+		return traits_type::to_int_type(*gptr());
+	}
+};
+
+// Terminal Input Struct (Lines typed at the console)
+struct TerminalInput : public InputSource
+{
+	bool nextLine(string &text) override
+	{
+		return static_cast<bool>(getline(cin, text));
+	}
+};
+
+// Script Input Struct (Lines from a recorded script file. A first line "# seed N" written by
+// the recorder is read apart, so the script replays the same battles.)
+struct ScriptInput : public InputSource
+{
+	ifstream file;
+	uint64_t seed = 0;
+	bool hasSeed = false;
+	string pending;
+	bool hasPending = false;
+
+	bool open(const char *path)
+	{
+		file.open(path, ios::binary);
+		if (!file)
+		{
+			return false;
+		}
+
+		// Header
+		if (getline(file, pending))
+		{
+			hasPending = true;
+
+			if (pending.compare(0, 7, "# seed ") == 0)
+			{
+				seed = stoull(pending.substr(7));
+				hasSeed = true;
+				hasPending = false;
+			}
+		}
+
+		return true;
+	}
+
+	bool nextLine(string &text) override
+	{
+		if (hasPending)
+		{
+			text.swap(pending);
+			hasPending = false;
+		}
+		else if (!getline(file, text))
+		{
+			return false;
+		}
+
+		// Scripts written on Windows
+		if (!text.empty() && text.back() == '\r')
+		{
+			text.pop_back();
+		}
+
+		return true;
+	}
+};
+
+// Vector Input Struct (Lines already in memory, so a replay never waits on the disk)
+struct VectorInput : public InputSource
+{
+	const vector<string> *script = nullptr;
+	size_t at = 0;
+
+	void rewind()
+	{
+		at = 0;
+		setg(nullptr, nullptr, nullptr);
+	}
+
+	bool nextLine(string &text) override
+	{
+		if (script == nullptr || at >= script->size())
+		{
+			return false;
+		}
+
+		text = (*script)[at++];
+		return true;
+	}
+};
+
+// Recording Input Struct (Passes another source through and writes every line it hands out to
+// a script that can be replayed later)
+struct RecordingInput : public InputSource
+{
+	InputSource *source = nullptr;
+	ofstream file;
+
+	bool open(const char *path, uint64_t seed)
+	{
+		file.open(path, ios::binary | ios::trunc);
+		file << "# seed " << seed << '\n';
+		return static_cast<bool>(file);
+	}
+
+	bool nextLine(string &text) override
+	{
+		if (!source->nextLine(text))
+		{
+			return false;
+		}
+
+		// Kept on Disk right away, so a session that crashes is still recorded
+		file << text << '\n';
+		file.flush();
+		return true;
+	}
+};
+
+// Heap Allocation Count (Every operator new on this thread, so the benchmarks can show how
+// many allocations a battle makes. Only the bench build (POKEMON_COUNT_ALLOCATIONS) replaces
+// the global allocator, the game keeps the standard one and the count stays 0.)
+thread_local long long heapAllocations = 0;
+
+#ifdef POKEMON_COUNT_ALLOCATIONS
+const bool COUNTING_ALLOCATIONS = true;
+
+// (Kept out of line: GCC otherwise inlines the pair into callers and warns malloc/free mismatch)
+#if defined(__GNUC__)
+#define HEAP_HOOK __attribute__((noinline))
+#else
+#define HEAP_HOOK
+#endif
+
+HEAP_HOOK void *operator new(size_t size)
+{
+	heapAllocations++;
+
+	if (void *memory = malloc(size > 0 ? size : 1))
+	{
+		return memory;
+	}
+
+	throw bad_alloc();
+}
+
+HEAP_HOOK void operator delete(void *memory) noexcept
+{
+	free(memory);
+}
+
+HEAP_HOOK void operator delete(void *memory, size_t) noexcept
+{
+	free(memory);
+}
+
+// (Over-aligned News too: the PMR new_delete_resource allocates through these. Windows has no
+// aligned_alloc, its aligned blocks come from _aligned_malloc and go back to _aligned_free.)
+HEAP_HOOK void *operator new(size_t size, align_val_t alignment)
+{
+	heapAllocations++;
+
+	size_t align = static_cast<size_t>(alignment);
+#ifdef _WIN32
+	void *memory = _aligned_malloc(max(size, size_t(1)), align);
+#else
+	void *memory = aligned_alloc(align, (max(size, size_t(1)) + align - 1) / align * align);
+#endif
+	if (memory != nullptr)
+	{
+		return memory;
+	}
+
+	throw bad_alloc();
+}
+
+HEAP_HOOK void operator delete(void *memory, align_val_t) noexcept
+{
+#ifdef _WIN32
+	_aligned_free(memory);
+#else
+	free(memory);
+#endif
+}
+
+HEAP_HOOK void operator delete(void *memory, size_t, align_val_t alignment) noexcept
+{
+	operator delete(memory, alignment);
+}
+#else
+const bool COUNTING_ALLOCATIONS = false;
+#endif
+
+// Global Battle Arena Switch (Off sends battle text to the heap, for comparing in bench)
+bool battleArenas = true;
+
+// Battle Arena Struct (Bump allocator for the text of one battle frame. Menu lines are PMR
+// strings built in it, and the whole frame's worth is dropped at once when the outermost
+// Arena Frame ends. Frames fit the inline buffer, the heap only backs overflow.)
+struct BattleArena
+{
+	static const size_t INLINE_BYTES = 2048;
+
+	alignas(max_align_t) char buffer[INLINE_BYTES];
+	pmr::monotonic_buffer_resource resource{ buffer, sizeof(buffer), pmr::new_delete_resource() };
+	int depth = 0;
+
+	pmr::memory_resource *memory()
+	{
+		return battleArenas ? static_cast<pmr::memory_resource *>(&resource) : pmr::new_delete_resource();
+	}
+};
+
+// Arena Frame Struct (Declared first in a function that builds battle text, so everything built
+// after it is gone before the arena is reset. Nested frames leave the reset to the outermost.)
+struct ArenaFrame
+{
+	BattleArena &arena;
+
+	ArenaFrame(BattleArena &arena) : arena(arena)
+	{
+		arena.depth++;
+	}
+
+	~ArenaFrame()
+	{
+		if (--arena.depth == 0)
+		{
+			arena.resource.release();
+		}
+	}
+};
+
+// Terminal Struct (Everything one player's screen needs: the frame being built, the battle
+// canvas, the arena battle text is built in and where input comes from. The console is one,
+// each server session has its own.)
+struct Terminal
+{
+	OutputBuffer output;
+	ScreenBuffer battleScreen;
+	istream input;
+	uint32_t traceTrack = 0;
+	LatencyStatistics latency;
+	BattleArena arena;
+
+	Terminal(streambuf *source) : input(source)
+	{
+		output.inputToFrame = &latency.metrics[LATENCY_INPUT_TO_FRAME];
+
+		// Running out of Input Throws InputClosed through the Menus
+		if (source != nullptr)
+		{
+			input.exceptions(ios::badbit);
+		}
+	}
+};
+
+// Global Input Sources
+TerminalInput terminalInput;
+ScriptInput scriptInput;
+RecordingInput recordingInput;
+
+// Global Terminals (The UI talks to whichever one terminal points at. Each thread has its
+// own, so Battle Scheduler threads can draw at the same time.)
+Terminal consoleTerminal(&terminalInput);
+thread_local Terminal *terminal = &consoleTerminal;
+thread_local ostream screen(&consoleTerminal.output);
+
+// Random Block Function (Turns a key and a 128 bit counter into 4 random numbers, keeps no state)
+typedef void (*RandomBlockFunction)(uint64_t key, const uint32_t counter[4], uint32_t out[4]);
+
+// Function Prototypes for Random Engines
+void philoxBlock(uint64_t key, const uint32_t counter[4], uint32_t out[4]);
+void splitMixBlock(uint64_t key, const uint32_t counter[4], uint32_t out[4]);
+
+// Game Seed (Set with --seed to replay a session) and the Engine every new Stream uses
+uint64_t gameSeed = 0;
+uint64_t battlesStarted = 0;
+RandomBlockFunction randomEngine = philoxBlock;
+
+// Random Stream Struct (Draw number drawIndex of stream (seed, stream) is always the same value)
+// Streams cost nothing to create, so every battle and every thread gets its own.
+struct RandomStream
+{
+	RandomBlockFunction engine = randomEngine;
+	uint64_t seed = 0;
+	uint64_t stream = 0;
+	uint64_t drawIndex = 0;
+	uint32_t block[4] = {};
+
+	RandomStream() {}
+
+	RandomStream(uint64_t streamSeed, uint64_t streamId)
+	{
+		seed = streamSeed;
+		stream = streamId;
+	}
+
+	void generate(uint64_t blockIndex, uint32_t out[4]) const
+	{
+		const uint32_t counter[4] = { static_cast<uint32_t>(blockIndex), static_cast<uint32_t>(blockIndex >> 32),
+			static_cast<uint32_t>(stream), static_cast<uint32_t>(stream >> 32) };
+		engine(seed, counter, out);
+	}
+
+	uint32_t next()
+	{
+		// Every 4 Draws share one Block
+		if ((drawIndex & 3) == 0)
+		{
+			generate(drawIndex >> 2, block);
+		}
+
+		return block[drawIndex++ & 3];
+	}
+
+	void seek(uint64_t index)
+	{
+		drawIndex = index;
+
+		if ((drawIndex & 3) != 0)
+		{
+			generate(drawIndex >> 2, block);
+		}
+	}
+
+	int roll(int range)
+	{
+		// Number between 0 and range - 1 (Multiply and Shift instead of Modulo)
+		return static_cast<int>((static_cast<uint64_t>(next()) * static_cast<uint32_t>(range)) >> 32);
+	}
+
+	void fill(uint32_t *out, size_t count)
+	{
+		size_t i = 0;
+
+		// Finish the Current Block
+		while (i < count && (drawIndex & 3) != 0)
+		{
+			out[i++] = next();
+		}
+
+		// Whole Blocks go straight to the Output
+		while (count - i >= 4)
+		{
+			generate(drawIndex >> 2, out + i);
+			drawIndex += 4;
+			i += 4;
+		}
+
+		// Leftovers
+		while (i < count)
+		{
+			out[i++] = next();
+		}
+	}
+};
+
+// Battle Action Struct (What the Player chose to do with their turn)
+struct BattleAction
+{
+	BattleActionType type = ACTION_ATTACK;
+	Status attackType = NORMAL;
+	int slot = 0;
+};
+
+// Battle Menu Transition Struct (What one selection does in one battle menu: move to another
+// menu, or pick an action for the Battle Core. A swap picks slot selection - 1.)
+struct MenuTransition
+{
+	MenuLocation next;
+	bool picks;
+	BattleActionType type;
+	Status attackType;
+};
+
+// Battle Menu Transition Tables (One row per MenuLocation, one column per selection 0 to 7
+// and a last column for any other selection)
+const int MENU_SELECTIONS = 8;
+const int MENU_LOCATIONS = 4;
+
+constexpr MenuTransition STAY_ATTACK = { ATTACK, false, ACTION_ATTACK, NORMAL };
+constexpr MenuTransition STAY_BAG = { BAG, false, ACTION_ATTACK, NORMAL };
+constexpr MenuTransition STAY_OVERVIEW = { OVERVIEW, false, ACTION_ATTACK, NORMAL };
+constexpr MenuTransition GO_ATTACK = STAY_ATTACK;
+constexpr MenuTransition GO_BAG = STAY_BAG;
+constexpr MenuTransition GO_SELECTION = { SELECTION, false, ACTION_ATTACK, NORMAL };
+constexpr MenuTransition GO_OVERVIEW = STAY_OVERVIEW;
+constexpr MenuTransition PICK_SWAP = { SELECTION, true, ACTION_SWAP, NORMAL };
+
+constexpr MenuTransition BATTLE_MENU[MENU_LOCATIONS][MENU_SELECTIONS + 1] =
+{
+	// ATTACK: 1. Move One, 2. Move Two, 3. Previous Menu
+	{ STAY_ATTACK, { ATTACK, true, ACTION_ATTACK, NORMAL }, { ATTACK, true, ACTION_ATTACK, SPECIAL }, GO_OVERVIEW,
+		STAY_ATTACK, STAY_ATTACK, STAY_ATTACK, STAY_ATTACK, STAY_ATTACK },
+	// BAG: 1. Elixir, 2. Pokeball, 3. Previous Menu
+	{ STAY_BAG, { BAG, true, ACTION_ELIXIR, NORMAL }, { BAG, true, ACTION_POKEBALL, NORMAL }, GO_OVERVIEW,
+		STAY_BAG, STAY_BAG, STAY_BAG, STAY_BAG, STAY_BAG },
+	// SELECTION: 1 to 6. Swap, 7. Previous Menu (Anything else is a swap the Battle Core turns down)
+	{ PICK_SWAP, PICK_SWAP, PICK_SWAP, PICK_SWAP, PICK_SWAP, PICK_SWAP, PICK_SWAP, GO_OVERVIEW, PICK_SWAP },
+	// OVERVIEW: 1. Attack, 2. Bag, 3. Pokemon, 4. Flee
+	{ STAY_OVERVIEW, GO_ATTACK, GO_BAG, GO_SELECTION, { OVERVIEW, true, ACTION_FLEE, NORMAL },
+		STAY_OVERVIEW, STAY_OVERVIEW, STAY_OVERVIEW, STAY_OVERVIEW }
+};
+
+// Battle Menu Statistics Struct (How often each battle menu led to each other menu or to a
+// picked action, and what drawing it and moving on cost. Column MENU_LOCATIONS is picked.)
+struct BattleMenuStatistics
+{
+	long long transitions[MENU_LOCATIONS][MENU_LOCATIONS + 1] = {};
+	long long nanos[MENU_LOCATIONS][MENU_LOCATIONS + 1] = {};
+
+	void add(MenuLocation from, int to, long long cost)
+	{
+		transitions[from][to]++;
+		nanos[from][to] += cost;
+	}
+
+	void merge(const BattleMenuStatistics &other)
+	{
+		for (int from = 0; from < MENU_LOCATIONS; from++)
+		{
+			for (int to = 0; to <= MENU_LOCATIONS; to++)
+			{
+				transitions[from][to] += other.transitions[from][to];
+				nanos[from][to] += other.nanos[from][to];
+			}
+		}
+	}
+};
+
+// Global Battle Menu Statistics (Each Battle Scheduler thread points at its own)
+BattleMenuStatistics consoleMenuStatistics;
+thread_local BattleMenuStatistics *menuStatistics = &consoleMenuStatistics;
+
+// Profile Points (Hot paths timed by the Profiler, built with -DPOKEMON_PROFILE)
+enum ProfilePoint { PROFILE_DRAW_BATTLE_UI, PROFILE_DRAW_BATTLE_STATUS, PROFILE_SAVE_GAME, PROFILE_LOAD_GAME, PROFILE_MENU_SELECTION, PROFILE_INPUT_WAIT, PROFILE_COMPUTER_ATTACK, PROFILE_TRAINER_ATTACK, PROFILE_POINTS };
+constexpr const char *ProfilePointNames[PROFILE_POINTS] = { "drawBattleUI", "drawBattleUIStatus", "saveGame", "loadGame", "getMenuSelection", "input wait", "computerAttack", "trainerAttack" };
+
+#ifdef POKEMON_PROFILE
+// Profile Counter Struct (Calls, total time and a log-linear histogram of call times for one
+// point on one thread. Only the owning thread writes, so plain loads and stores are enough and
+// a dump from another thread reads whole values.)
+struct ProfileCounter
+{
+	// 4 Buckets per Power of Two (Percentiles are within 25%)
+	static const int SUB_BUCKETS = 4;
+	static const int BUCKETS = 64 * SUB_BUCKETS;
+
+	atomic<uint64_t> calls{ 0 };
+	atomic<uint64_t> nanos{ 0 };
+	atomic<uint64_t> buckets[BUCKETS] = {};
+
+	static int bucketOf(uint64_t value)
+	{
+		if (value < SUB_BUCKETS)
+		{
+			return static_cast<int>(value);
+		}
+
+		int top = bit_width(value) - 1;
+		return (top - 1) * SUB_BUCKETS + static_cast<int>((value >> (top - 2)) & (SUB_BUCKETS - 1));
+	}
+
+	static uint64_t bucketMiddle(int bucket)
+	{
+		if (bucket < SUB_BUCKETS)
+		{
+			return bucket;
+		}
+
+		int top = bucket / SUB_BUCKETS + 1;
+		uint64_t low = static_cast<uint64_t>(SUB_BUCKETS + bucket % SUB_BUCKETS) << (top - 2);
+		return low + (uint64_t(1) << (top - 2)) / 2;
+	}
+
+	void add(uint64_t value)
+	{
+		calls.store(calls.load(memory_order_relaxed) + 1, memory_order_relaxed);
+		nanos.store(nanos.load(memory_order_relaxed) + value, memory_order_relaxed);
+		atomic<uint64_t> &bucket = buckets[bucketOf(value)];
+		bucket.store(bucket.load(memory_order_relaxed) + 1, memory_order_relaxed);
+	}
+};
+
+// Profile Thread Struct (Every thread that hits a profile point gets one, registered with the
+// Profiler on first use. When the thread ends its counts are kept by the Profiler.)
+struct ProfileThread
+{
+	ProfileCounter counters[PROFILE_POINTS];
+
+	ProfileThread();
+	~ProfileThread();
+};
+
+// Profile Totals Struct (Counters of every thread added up, for the dump)
+struct ProfileTotals
+{
+	uint64_t calls[PROFILE_POINTS] = {};
+	uint64_t nanos[PROFILE_POINTS] = {};
+	uint64_t buckets[PROFILE_POINTS][ProfileCounter::BUCKETS] = {};
+	int threads = 0;
+
+	void add(const ProfileThread &thread)
+	{
+		for (int p = 0; p < PROFILE_POINTS; p++)
+		{
+			calls[p] += thread.counters[p].calls.load(memory_order_relaxed);
+			nanos[p] += thread.counters[p].nanos.load(memory_order_relaxed);
+			for (int b = 0; b < ProfileCounter::BUCKETS; b++)
+			{
+				buckets[p][b] += thread.counters[p].buckets[b].load(memory_order_relaxed);
+			}
+		}
+	}
+
+	uint64_t percentile(int point, double fraction) const
+	{
+		uint64_t rank = static_cast<uint64_t>(ceil(fraction * calls[point]));
+		uint64_t seen = 0;
+
+		for (int b = 0; b < ProfileCounter::BUCKETS; b++)
+		{
+			seen += buckets[point][b];
+			if (seen >= rank && seen > 0)
+			{
+				return ProfileCounter::bucketMiddle(b);
+			}
+		}
+
+		return 0;
+	}
+};
+
+// Profiler Struct (Every live Profile Thread, and what threads that already ended counted)
+struct Profiler
+{
+	mutex lock;
+	vector<ProfileThread *> threads;
+	unique_ptr<ProfileTotals> retired = make_unique<ProfileTotals>();
+	int retiredThreads = 0;
+};
+
+// Global Profiler (The thread's own counters are made on its first profiled call)
+Profiler profiler;
+thread_local ProfileThread profileThread;
+
+ProfileThread::ProfileThread()
+{
+	lock_guard<mutex> guard(profiler.lock);
+	profiler.threads.push_back(this);
+}
+
+ProfileThread::~ProfileThread()
+{
+	lock_guard<mutex> guard(profiler.lock);
+	profiler.retired->add(*this);
+	profiler.retiredThreads++;
+	profiler.threads.erase(find(profiler.threads.begin(), profiler.threads.end(), this));
+}
+
+// Profile Scope Struct (Times the rest of the block it is declared in)
+struct ProfileScope
+{
+	ProfilePoint point;
+	chrono::steady_clock::time_point start;
+
+	ProfileScope(ProfilePoint point) : point(point), start(chrono::steady_clock::now())
+	{
+	}
+
+	~ProfileScope()
+	{
+		profileThread.counters[point].add(chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count());
+	}
+};
+
+#define PROFILE_JOIN_NAME(name, line) name##line
+#define PROFILE_NAME(name, line) PROFILE_JOIN_NAME(name, line)
+#define PROFILE_SCOPE(point) ProfileScope PROFILE_NAME(profileScope, __LINE__)(point)
+#else
+// Profiling is compiled out, nothing is timed
+#define PROFILE_SCOPE(point) ((void)0)
+#endif
+
+// Trace Event Struct (One finished span: what it was, when it started, how long it took in
+// clock ticks, whose session it belongs to and one number to show with it)
+struct TraceEvent
+{
+	const char *name;
+	uint64_t start;
+	uint64_t duration;
+	uint32_t track;
+	int32_t arg;
+};
+
+// Trace Buffer Struct (A ring of finished spans for one thread. The thread pushes, the Tracer's
+// flush takes, and neither ever waits for the other: a full ring drops the new span and counts it.)
+struct TraceBuffer
+{
+	static const uint64_t CAPACITY = 1 << 16;
+
+	unique_ptr<TraceEvent[]> events = make_unique<TraceEvent[]>(CAPACITY);
+	atomic<uint64_t> head{ 0 };
+	atomic<uint64_t> tail{ 0 };
+	atomic<uint64_t> dropped{ 0 };
+	uint32_t thread = 0;
+
+	void push(const TraceEvent &event)
+	{
+		uint64_t at = head.load(memory_order_relaxed);
+
+		if (at - tail.load(memory_order_acquire) >= CAPACITY)
+		{
+			dropped.store(dropped.load(memory_order_relaxed) + 1, memory_order_relaxed);
+			return;
+		}
+
+		events[at & (CAPACITY - 1)] = event;
+		head.store(at + 1, memory_order_release);
+	}
+
+	void discard()
+	{
+		tail.store(head.load(memory_order_acquire), memory_order_release);
+	}
+};
+
+// Random Stream the Tracer Samples Sessions with ("trace", apart from the battle streams)
+const uint64_t TRACE_SAMPLE_STREAM = 0x7472616365;
+
+// Tracer Struct (Collects spans from every thread into a Chrome / Perfetto JSON trace file, see
+// chrome://tracing or ui.perfetto.dev. A thread flushes the rings to the file a few times a
+// second. Every traced session shows up as a process of its own, its threads inside it.)
+struct Tracer
+{
+	atomic<bool> enabled{ false };
+	int sample = 1;
+	ofstream file;
+	bool firstEvent = true;
+	mutex lock;
+	vector<unique_ptr<TraceBuffer>> buffers;
+	vector<pair<uint32_t, string>> newTracks;
+	uint32_t tracks = 0;
+	uint64_t candidates = 0;
+	thread flusher;
+	condition_variable wake;
+	bool stopping = false;
+	uint64_t startTicks = 0;
+	chrono::steady_clock::time_point startTime;
+
+	static uint64_t ticks()
+	{
+#if defined(BATTLE_SIMD)
+		// Time Stamp Counter (Cheaper than the clock, converted to microseconds when flushed)
+		return __rdtsc();
+#else
+		return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+	}
+
+	bool start(const char *path)
+	{
+		file.open(path, ios::out | ios::trunc);
+		if (!file)
+		{
+			return false;
+		}
+
+		file << "{\"traceEvents\":[";
+		startTicks = ticks();
+		startTime = chrono::steady_clock::now();
+		enabled = true;
+
+		flusher = thread([this]()
+		{
+			unique_lock<mutex> guard(lock);
+			while (!stopping)
+			{
+				wake.wait_for(guard, chrono::milliseconds(250));
+				flush();
+			}
+		});
+
+		return true;
+	}
+
+	// A new Track for a Session, or 0 if it isn't in the Sample (Shown as "name track")
+	uint32_t sampleTrack(const string &name)
+	{
+		if (!enabled)
+		{
+			return 0;
+		}
+
+		lock_guard<mutex> guard(lock);
+
+		// Track number candidates of the run is Traced if its Draw of the Sample Stream hits 1 in
+		// sample (The same seed samples the same sessions)
+		RandomStream draw(gameSeed, TRACE_SAMPLE_STREAM);
+		draw.seek(candidates++);
+		if (sample > 1 && draw.next() % static_cast<uint32_t>(sample) != 0)
+		{
+			return 0;
+		}
+
+		tracks++;
+		newTracks.emplace_back(tracks, name + " " + to_string(tracks));
+		return tracks;
+	}
+
+	TraceBuffer &threadBuffer();
+
+	// Writes out Everything the Rings Hold (Caller holds the lock)
+	void flush()
+	{
+		if (!file.is_open())
+		{
+			return;
+		}
+
+		// Ticks per Microsecond, measured over the whole Trace so far
+		double elapsed = chrono::duration<double, micro>(chrono::steady_clock::now() - startTime).count();
+		double perMicro = (elapsed > 0) ? (ticks() - startTicks) / elapsed : 1000.0;
+
+		file << fixed << setprecision(3);
+
+		for (auto &[track, name] : newTracks)
+		{
+			file << (firstEvent ? "\n" : ",\n") << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << track << ",\"args\":{\"name\":\"" << name << "\"}}";
+			firstEvent = false;
+		}
+		newTracks.clear();
+
+		for (unique_ptr<TraceBuffer> &buffer : buffers)
+		{
+			uint64_t from = buffer->tail.load(memory_order_relaxed);
+			uint64_t to = buffer->head.load(memory_order_acquire);
+
+			for (uint64_t i = from; i < to; i++)
+			{
+				const TraceEvent &event = buffer->events[i & (TraceBuffer::CAPACITY - 1)];
+
+				file << (firstEvent ? "\n" : ",\n") << "{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":" << event.track
+					<< ",\"tid\":" << buffer->thread << ",\"ts\":" << (event.start - startTicks) / perMicro
+					<< ",\"dur\":" << event.duration / perMicro << ",\"args\":{\"n\":" << event.arg << "}}";
+				firstEvent = false;
+			}
+
+			buffer->tail.store(to, memory_order_release);
+		}
+
+		file.flush();
+	}
+
+	void stop()
+	{
+		{
+			lock_guard<mutex> guard(lock);
+			if (!enabled)
+			{
+				return;
+			}
+
+			enabled = false;
+			stopping = true;
+		}
+
+		wake.notify_all();
+		if (flusher.joinable())
+		{
+			flusher.join();
+		}
+
+		// Last of the Spans and how many didn't Fit
+		lock_guard<mutex> guard(lock);
+		flush();
+
+		uint64_t dropped = 0;
+		for (unique_ptr<TraceBuffer> &buffer : buffers)
+		{
+			dropped += buffer->dropped.load(memory_order_relaxed);
+		}
+
+		if (file.is_open())
+		{
+			file << "\n],\"displayTimeUnit\":\"ns\",\"otherData\":{\"dropped\":" << dropped << "}}" << endl;
+			file.close();
+		}
+	}
+
+	~Tracer()
+	{
+		stop();
+	}
+};
+
+// Global Tracer (Off unless --trace FILE is given. Each thread gets its ring on its first span.)
+Tracer tracer;
+thread_local TraceBuffer *traceBuffer = nullptr;
+
+TraceBuffer &Tracer::threadBuffer()
+{
+	if (traceBuffer == nullptr)
+	{
+		lock_guard<mutex> guard(lock);
+		buffers.push_back(make_unique<TraceBuffer>());
+		buffers.back()->thread = static_cast<uint32_t>(buffers.size());
+		traceBuffer = buffers.back().get();
+	}
+
+	return *traceBuffer;
+}
+
+// Trace Span Struct (Records the rest of the block it is declared in, if this session is traced)
+struct TraceSpan
+{
+	const char *name;
+	int32_t arg;
+	uint32_t track;
+	uint64_t start = 0;
+
+	TraceSpan(const char *name, int arg = 0) : name(name), arg(arg), track(tracer.enabled ? terminal->traceTrack : 0)
+	{
+		if (track != 0)
+		{
+			start = Tracer::ticks();
+		}
+	}
+
+	~TraceSpan()
+	{
+		if (track != 0)
+		{
+			tracer.threadBuffer().push({ name, start, Tracer::ticks() - start, track, arg });
+		}
+	}
+};
+
+// Battle Event Struct (Something that happened while a turn was resolved)
+struct BattleEvent
+{
+	BattleEventType type;
+	Status actor = PLAYER;
+	Status result = SUCCESS;
+	int move = 0;
+	int amount = 0;
+	int money = 0;
+	int slot = 0;
+};
+
+// Battle Events Struct (Every event produced by a single turn, in order)
+struct BattleEvents
+{
+	BattleEvent events[MAX_TURN_EVENTS];
+	int eventCount = 0;
+
+	void add(BattleEvent event)
+	{
+		if (eventCount < MAX_TURN_EVENTS)
+		{
+			events[eventCount] = event;
+			eventCount++;
+		}
+	}
+};
+
+// Battle State Struct (Everything needed to resolve a battle without any UI)
+struct BattleState
+{
+	PlayerData *trainer = nullptr;
+	PokemonData opponent;
+	BattlePhase phase = PHASE_ACTION;
+	Status outcome = BATTLE_CONTINUE;
+	bool computerFirst = false;
+	int turns = 0;
+	RandomStream random;
+};
+
+// Battle Input Struct (What a suspended battle is waiting for and the answer it is resumed
+// with. A selection is a menu number, Enter carries nothing.)
+struct BattleInput
+{
+	BattleInputKind waiting = INPUT_NONE;
+	int value = 0;
+
+	struct Awaiter
+	{
+		BattleInput &input;
+		BattleInputKind kind;
+
+		bool await_ready() const noexcept
+		{
+			return false;
+		}
+
+		void await_suspend(coroutine_handle<>) noexcept
+		{
+			input.waiting = kind;
+		}
+
+		int await_resume() noexcept
+		{
+			input.waiting = INPUT_NONE;
+			return input.value;
+		}
+	};
+
+	Awaiter selection()
+	{
+		return Awaiter{ *this, INPUT_SELECTION };
+	}
+
+	Awaiter enter()
+	{
+		return Awaiter{ *this, INPUT_ENTER };
+	}
+};
+
+// Global Battle Frame Count (Live coroutine frames and their bytes)
+atomic<long long> battleFrames(0);
+atomic<long long> battleFrameBytes(0);
+
+// Battle Task Struct (Owns one battle coroutine. It starts suspended, every resume() runs it
+// until it waits for input again or the battle is over, and the frame goes with the task.)
+struct BattleTask
+{
+	struct promise_type
+	{
+		BattleTask get_return_object()
+		{
+			return BattleTask(coroutine_handle<promise_type>::from_promise(*this));
+		}
+
+		suspend_always initial_suspend() noexcept
+		{
+			return {};
+		}
+
+		suspend_always final_suspend() noexcept
+		{
+			return {};
+		}
+
+		void return_void()
+		{
+		}
+
+		void unhandled_exception()
+		{
+			// Thrown on to whoever Resumed the Battle
+			throw;
+		}
+
+		static void *operator new(size_t size)
+		{
+			battleFrames++;
+			battleFrameBytes += size;
+			return ::operator new(size);
+		}
+
+		static void operator delete(void *frame, size_t size)
+		{
+			battleFrames--;
+			battleFrameBytes -= size;
+			::operator delete(frame);
+		}
+	};
+
+	coroutine_handle<promise_type> handle;
+
+	BattleTask()
+	{
+	}
+
+	explicit BattleTask(coroutine_handle<promise_type> coroutine) : handle(coroutine)
+	{
+	}
+
+	BattleTask(BattleTask &&other) noexcept : handle(other.handle)
+	{
+		other.handle = nullptr;
+	}
+
+	BattleTask &operator=(BattleTask &&other) noexcept
+	{
+		if (this != &other)
+		{
+			if (handle)
+			{
+				handle.destroy();
+			}
+			handle = other.handle;
+			other.handle = nullptr;
+		}
+		return *this;
+	}
+
+	BattleTask(const BattleTask &) = delete;
+	BattleTask &operator=(const BattleTask &) = delete;
+
+	~BattleTask()
+	{
+		if (handle)
+		{
+			handle.destroy();
+		}
+	}
+};
+
+// Battle Batch Struct (Many one-on-one battles stored as one array per field, so a
+// whole turn can be resolved for every battle at once by the damage kernel)
+struct BattleBatch
+{
+	int count = 0;
+	int running = 0;
+	RandomStream random;
+
+	// Battle Fields
+	vector<int32_t> playerHealth;
+	vector<int32_t> playerLevel;
+	vector<int32_t> playerDead;
+	vector<int32_t> opponentHealth;
+	vector<int32_t> opponentLevel;
+	vector<int32_t> opponentDead;
+	vector<int32_t> turns;
+
+	// Scratch Space reused every Turn
+	vector<uint32_t> draws;
+	vector<int32_t> playerRoll;
+	vector<int32_t> computerRoll;
+	vector<int32_t> status;
+	vector<int32_t> skip;
+};
+
+// Damage Kernel (Applies one attack to count battles laid out as arrays)
+typedef void (*DamageKernel)(const int32_t *roll, const int32_t *level, const int32_t *skip, int32_t *health, int32_t *dead, int32_t *status, int count);
+
+// Function Prototypes for Damage Kernels
+void damageKernelScalar(const int32_t *roll, const int32_t *level, const int32_t *skip, int32_t *health, int32_t *dead, int32_t *status, int count);
+
+// Damage Kernel used by Batches (Chosen in initGame, or with --simd)
+DamageKernel damageKernel = damageKernelScalar;
+
+// Simulation Config Struct (What to Simulate)
+struct SimulationConfig
+{
+	int battles = 10000;
+	PokemonSpecies species = BULBASAUR;
+	int level = 5;
+	int pokeballs = 0;
+	int elixirs = 0;
+	int threads = 0;
+	bool batch = false;
+	bool coroutines = false;
+	uint64_t seed = 0;
+};
+
+// Simulation Result Struct (Totals gathered over many battles, one per worker thread)
+struct alignas(64) SimulationResult
+{
+	long long battles = 0;
+	long long wins = 0;
+	long long losses = 0;
+	long long caught = 0;
+	long long fled = 0;
+	long long turns = 0;
+	long long money = 0;
+	long long exp = 0;
+
+	void merge(const SimulationResult &other)
+	{
+		battles += other.battles;
+		wins += other.wins;
+		losses += other.losses;
+		caught += other.caught;
+		fled += other.fled;
+		turns += other.turns;
+		money += other.money;
+		exp += other.exp;
+	}
+};
+
+// Battle Session Struct (One battle run by the Battle Scheduler: the Trainer it is played
+// for, the coroutine playing it and what it waits for. Scripted players queue menu numbers.)
+struct BattleSession
+{
+	PlayerData trainer;
+	BattleState battle;
+	BattleInput input;
+	BattleTask task;
+	int shard = 0;
+	int script[2] = {};
+	int scriptLength = 0;
+	int scriptAt = 0;
+};
+
+// Battle Scheduler Struct (Runs many battle coroutines on a few threads. Each battle stays on
+// one thread's shard. A worker resumes a ready battle until it waits for input, then asks
+// answer() for it: answered battles go to the back of the queue, the rest wait for deliver().
+// What the battles draw goes to the shard's Terminal and is thrown away.)
+struct BattleScheduler
+{
+	struct alignas(64) Shard
+	{
+		mutex lock;
+		condition_variable wake;
+		deque<BattleSession *> ready;
+		Terminal terminal;
+		BattleMenuStatistics menuStatistics;
+		long long resumes = 0;
+		bool stopping = false;
+
+		Shard() : terminal(nullptr)
+		{
+		}
+	};
+
+	function<bool(BattleSession &session)> answer;
+	function<void(BattleSession &session, int shard)> finished;
+	vector<unique_ptr<Shard>> shards;
+	vector<thread> threads;
+	int nextShard = 0;
+	atomic<long long> busy{ 0 };
+	mutex idleLock;
+	condition_variable idle;
+
+	void start(int threadCount)
+	{
+		for (int i = 0; i < threadCount; i++)
+		{
+			shards.emplace_back(new Shard());
+		}
+
+		for (int i = 0; i < threadCount; i++)
+		{
+			threads.emplace_back(&BattleScheduler::loop, this, i);
+		}
+	}
+
+	// New Battle (Runs until it first waits for input)
+	void spawn(BattleSession &session)
+	{
+		session.shard = nextShard;
+		nextShard = (nextShard + 1) % static_cast<int>(shards.size());
+		ready(session);
+	}
+
+	void deliver(BattleSession &session, int value)
+	{
+		session.input.value = value;
+		ready(session);
+	}
+
+	void ready(BattleSession &session)
+	{
+		Shard &shard = *shards[session.shard];
+		busy++;
+
+		{
+			lock_guard<mutex> guard(shard.lock);
+			shard.ready.push_back(&session);
+		}
+
+		shard.wake.notify_one();
+	}
+
+	// Wait until every Battle is Finished or Waiting for deliver()
+	void drain()
+	{
+		unique_lock<mutex> guard(idleLock);
+		idle.wait(guard, [this] { return busy == 0; });
+	}
+
+	void stop()
+	{
+		for (unique_ptr<Shard> &shard : shards)
+		{
+			lock_guard<mutex> guard(shard->lock);
+			shard->stopping = true;
+		}
+
+		for (unique_ptr<Shard> &shard : shards)
+		{
+			shard->wake.notify_all();
+		}
+
+		for (thread &worker : threads)
+		{
+			worker.join();
+		}
+
+		threads.clear();
+	}
+
+	void loop(int id)
+	{
+		Shard &shard = *shards[id];
+		terminal = &shard.terminal;
+		screen.rdbuf(&shard.terminal.output);
+		menuStatistics = &shard.menuStatistics;
+
+		unique_lock<mutex> guard(shard.lock);
+
+		while (true)
+		{
+			shard.wake.wait(guard, [&shard] { return !shard.ready.empty() || shard.stopping; });
+
+			if (shard.ready.empty())
+			{
+				break;
+			}
+
+			BattleSession &session = *shard.ready.front();
+			shard.ready.pop_front();
+			guard.unlock();
+
+			session.task.handle.resume();
+			shard.resumes++;
+			shard.terminal.output.bytes.clear();
+
+			bool again = false;
+			if (session.task.handle.done())
+			{
+				if (finished)
+				{
+					finished(session, id);
+				}
+			}
+			else
+			{
+				again = answer && answer(session);
+			}
+
+			guard.lock();
+
+			if (again)
+			{
+				shard.ready.push_back(&session);
+			}
+			else if (--busy == 0)
+			{
+				lock_guard<mutex> idleGuard(idleLock);
+				idle.notify_all();
+			}
+		}
+	}
+
+	~BattleScheduler()
+	{
+		if (!threads.empty())
+		{
+			stop();
+		}
+	}
+};
+
+// Coroutine Benchmark Struct (What simulate --coroutines measured besides the battles)
+struct CoroutineBenchmark
+{
+	long long switches = 0;
+	double switchNanos = 0;
+	double fiberSwitchNanos = 0;
+	long long resumes = 0;
+	double resumeNanos = 0;
+	long long framesInFlight = 0;
+	long long frameBytes = 0;
+	size_t sessionBytes = 0;
+	size_t residentBytes = 0;
+	BattleMenuStatistics menuStatistics;
+	LatencyStatistics latency;
+};
+
+// Benchmark Config Struct (How the bench suite runs: untimed warm-up runs, then timed repetitions)
+struct BenchmarkConfig
+{
+	int warmup = 3;
+	int repetitions = 10;
+	string filter;
+	const char *output = nullptr;
+	uint64_t seed = 1;
+};
+
+// Benchmark Struct (One hot path of the game. run(n) performs n operations of it.)
+struct Benchmark
+{
+	const char *name;
+	const char *unit;
+	long long operations;
+	function<void(long long)> run;
+};
+
+// Benchmark Result Struct (Nanoseconds per operation of every timed repetition and their spread,
+// and the heap allocations per operation when the build counts them)
+struct BenchmarkResult
+{
+	string name;
+	string unit;
+	long long operations = 0;
+	vector<double> samples;
+	double mean = 0;
+	double stddev = 0;
+	double min = 0;
+	double median = 0;
+	double max = 0;
+	double allocations = 0;
+
+	void summarize()
+	{
+		if (samples.empty())
+		{
+			return;
+		}
+
+		vector<double> sorted = samples;
+		sort(sorted.begin(), sorted.end());
+
+		double sum = 0;
+		for (double sample : sorted)
+		{
+			sum += sample;
+		}
+
+		mean = sum / sorted.size();
+
+		double squares = 0;
+		for (double sample : sorted)
+		{
+			squares += (sample - mean) * (sample - mean);
+		}
+
+		stddev = (sorted.size() > 1) ? sqrt(squares / (sorted.size() - 1)) : 0.0;
+		min = sorted.front();
+		max = sorted.back();
+		median = (sorted.size() % 2 == 1) ? sorted[sorted.size() / 2] : (sorted[sorted.size() / 2 - 1] + sorted[sorted.size() / 2]) / 2;
+	}
+};
+
+// Global Benchmark Sink (Benchmarks add their results here so the work can't be optimized away)
+atomic<long long> benchmarkSink{ 0 };
+
+// Ingest Worker Struct (What one ingest-saves thread reuses from file to file, so parsing
+// never allocates once the buffers have grown)
+struct alignas(64) IngestWorker
+{
+	string bytes;
+	PlayerData player;
+	LegacyParseError error;
+	StoreSlot slot;
+	long long imported = 0;
+	long long failed = 0;
+	size_t bytesParsed = 0;
+	chrono::steady_clock::duration parseTime{};
+};
+
+// Work Stealing Pool Struct (Runs numbered tasks on every core)
+// Each worker owns a queue and takes its newest task first. Once its own
+// queue runs dry it steals the oldest task of another worker instead.
+struct WorkStealingPool
+{
+	struct alignas(64) WorkQueue
+	{
+		mutex lock;
+		deque<int> tasks;
+	};
+
+	int threadCount;
+	vector<unique_ptr<WorkQueue>> queues;
+
+	WorkStealingPool(int threads)
+	{
+		threadCount = (threads > 0) ? threads : max(1, static_cast<int>(thread::hardware_concurrency()));
+	}
+
+	void run(int taskCount, const function<void(int worker, int task)> &work)
+	{
+		// Deal the Tasks out Evenly
+		queues.clear();
+		for (int i = 0; i < threadCount; i++)
+		{
+			queues.push_back(make_unique<WorkQueue>());
+		}
+
+		for (int task = 0; task < taskCount; task++)
+		{
+			queues[task % threadCount]->tasks.push_back(task);
+		}
+
+		// Worker Loop
+		auto worker = [&](int id)
+		{
+			int task;
+			while (nextTask(id, task))
+			{
+				work(id, task);
+			}
+		};
+
+		// The Calling Thread is Worker 0
+		vector<thread> threads;
+		for (int i = 1; i < threadCount; i++)
+		{
+			threads.emplace_back(worker, i);
+		}
+
+		worker(0);
+
+		for (thread &t : threads)
+		{
+			t.join();
+		}
+	}
+
+	bool nextTask(int worker, int &task)
+	{
+		// Newest Task from our own Queue
+		{
+			WorkQueue &own = *queues[worker];
+			lock_guard<mutex> guard(own.lock);
+			if (!own.tasks.empty())
+			{
+				task = own.tasks.back();
+				own.tasks.pop_back();
+				return true;
+			}
+		}
+
+		// Oldest Task from Someone Else's Queue (No new tasks are ever added, so empty everywhere means done)
+		for (int i = 1; i < threadCount; i++)
+		{
+			WorkQueue &victim = *queues[(worker + i) % threadCount];
+			lock_guard<mutex> guard(victim.lock);
+			if (!victim.tasks.empty())
+			{
+				task = victim.tasks.front();
+				victim.tasks.pop_front();
+				return true;
+			}
+		}
+
+		return false;
+	}
+};
+
+// Save Worker Struct (Writes saves on a background thread so the menus never wait on the disk)
+// request() only copies the player. Saves of one trainer that pile up while others are being
+// written collapse into the newest. Every few seconds the worker calls writeBack, busy or not,
+// and flush() waits until the trainer's saves are written, then writes that trainer back so it
+// is on disk.
+struct SaveWorker
+{
+	void (*write)(const PlayerData &) = nullptr;
+	void (*writeBack)() = nullptr;
+	void (*writeBackTrainer)(const string &name) = nullptr;
+	mutex lock;
+	condition_variable wake;
+	condition_variable idle;
+	thread worker;
+	unordered_map<string, PlayerData> pending;
+	bool writing = false;
+	bool stopping = false;
+	long long requested = 0;
+	long long coalesced = 0;
+
+	void request(const PlayerData &player)
+	{
+		{
+			lock_guard<mutex> guard(lock);
+
+			if (!worker.joinable())
+			{
+				worker = thread(&SaveWorker::loop, this);
+			}
+
+			auto queued = pending.find(player.name);
+
+			if (queued != pending.end())
+			{
+				queued->second = player;
+				coalesced++;
+			}
+			else
+			{
+				pending.emplace(player.name, player);
+			}
+
+			requested++;
+		}
+
+		wake.notify_one();
+	}
+
+	void flush(const string &name)
+	{
+		{
+			unique_lock<mutex> guard(lock);
+			idle.wait(guard, [this, &name] { return pending.count(name) == 0 && !writing; });
+		}
+
+		if (writeBackTrainer != nullptr)
+		{
+			writeBackTrainer(name);
+		}
+	}
+
+	void stop()
+	{
+		{
+			lock_guard<mutex> guard(lock);
+			stopping = true;
+		}
+
+		wake.notify_one();
+
+		if (worker.joinable())
+		{
+			worker.join();
+		}
+
+		if (writeBack != nullptr)
+		{
+			writeBack();
+		}
+	}
+
+	void loop()
+	{
+		unordered_map<string, PlayerData> batch;
+		unique_lock<mutex> guard(lock);
+		auto nextWriteBack = chrono::steady_clock::now() + chrono::seconds(TRAINER_CACHE_WRITE_BACK_SECONDS);
+
+		while (true)
+		{
+			wake.wait_until(guard, nextWriteBack, [this] { return !pending.empty() || stopping; });
+
+			// Write Back on Schedule, even while Saves keep Arriving
+			if (chrono::steady_clock::now() >= nextWriteBack)
+			{
+				nextWriteBack = chrono::steady_clock::now() + chrono::seconds(TRAINER_CACHE_WRITE_BACK_SECONDS);
+
+				if (writeBack != nullptr)
+				{
+					guard.unlock();
+					writeBack();
+					guard.lock();
+				}
+			}
+
+			// Anything Requested is Written before Stopping
+			if (pending.empty())
+			{
+				if (stopping)
+				{
+					break;
+				}
+				continue;
+			}
+
+			swap(batch, pending);
+			writing = true;
+
+			guard.unlock();
+			for (const auto &queued : batch)
+			{
+				write(queued.second);
+			}
+			batch.clear();
+			guard.lock();
+
+			writing = false;
+			idle.notify_all();
+		}
+	}
+
+	~SaveWorker()
+	{
+		stop();
+	}
+};
+
+// Global Save Worker
+SaveWorker saveWorker;
+
+// Session Server Constants
+const char *const SERVER_SOCKET = "pokemon.sock";
+const size_t SESSION_STACK_SIZE = 1024 * 1024;
+const size_t SESSION_READ_SIZE = 4096;
+const size_t SESSION_OUTBOX_LIMIT = 1024 * 1024;
+const int    SERVER_EVENTS = 256;
+
+#ifdef HAVE_EPOLL
+struct Session;
+void sessionWait(Session &session);
+
+// Session Input Struct (Hands the menus what the client has sent. When it runs dry the session
+// goes back to the server loop until more arrives.)
+struct SessionInput : public streambuf
+{
+	Session *session = nullptr;
+	string received;
+	bool closed = false;
+
+	int_type underflow() override
+	{
+		if (gptr() < egptr())
+		{
+			return traits_type::to_int_type(*gptr());
+		}
+
+		// Wait for the Client (The server loop appends to received meanwhile)
+		received.clear();
+		while (received.empty())
+		{
+			if (closed)
+			{
+				throw InputClosed();
+			}
+
+			sessionWait(*session);
+		}
+
+		setg(&received[0], &received[0], &received[0] + received.size());
+		return traits_type::to_int_type(*gptr());
+	}
+};
+
+// Session Struct (One connected client: its own Terminal, Trainer and a fiber with its own
+// stack that runs the ordinary blocking menus. Only the server loop ever resumes it.)
+struct Session
+{
+	int fd = -1;
+	SessionInput in;
+	Terminal terminal;
+	PlayerData trainer;
+	string outbox;
+	size_t outboxSent = 0;
+	bool watchingWrites = false;
+	bool started = false;
+	bool finished = false;
+	ucontext_t context;
+	char *stack = nullptr;
+	size_t stackBytes = 0;
+
+	Session(int client) : fd(client), terminal(&in)
+	{
+		in.session = this;
+		terminal.output.outbox = &outbox;
+		terminal.battleScreen.console = false;
+	}
+
+	~Session()
+	{
+		if (stack != nullptr)
+		{
+			munmap(stack, stackBytes);
+		}
+
+		if (fd >= 0)
+		{
+			close(fd);
+		}
+	}
+};
+
+// Global Session Server (Sessions take turns on the one loop thread, so the game's tables and
+// globals are shared without locks. Only the Save Worker runs beside it.)
+ucontext_t serverContext;
+Session *runningSession = nullptr;
+LatencyStatistics serverLatency;
+volatile sig_atomic_t serverStopping = 0;
+#endif
+
+// Function Prototypes for Debug Purposes
+void displayData(PlayerData player);
+
+// Function Prototypes for Helper Functions
+void   clear();
+void   pressEnterToContinue();
+void   promptEnter();
+void   waitForEnter();
+int    getMenuSelection();
+void   promptSelection();
+int    readSelection();
+void   drawLines(int lines, ostream &out = screen);
+void   printMessage(const Message &message, ostream &out = screen);
+size_t decodeMessage(span<const uint8_t> record, Message &message);
+pmr::string arenaNumber(long long value, pmr::memory_resource *memory);
+
+// Function Prototypes for Initilization Functions
+void initGame();
+bool initSprites(const char *path);
+int  embedSpritesMode(int argc, char *argv[]);
+bool initOptions(int argc, char *argv[]);
+RandomBlockFunction randomEngineByName(const string &name);
+
+// Function Prototypes for Files
+bool     gameExists();
+void     saveGame(const PlayerData &player);
+Status   loadGame(const StoreEntry &entry, PlayerData &player, string &error);
+bool     loadLegacyGame(const char *path, PlayerData &player, LegacyParseError &error);
+bool     parseLegacySave(string_view text, PlayerData &player, LegacyParseError &error);
+int      ingestSavesMode(int argc, char *argv[]);
+int      replayMode(int argc, char *argv[]);
+string   encodeSave(const PlayerData &player);
+bool     decodeSave(const string &bytes, PlayerData &player, string &error);
+bool     journalDelta(const PlayerData &saved, const PlayerData &player, SaveWriter &out);
+size_t   replayJournalFrames(const string &bytes, size_t at, PlayerData &player);
+bool     applyJournalFrame(const SaveReader &in, size_t at, size_t end, PlayerData &player);
+bool     readWholeFile(const char *path, string &bytes);
+uint32_t crc32c(const void *data, size_t length, uint32_t crc = 0);
+
+// Function Prototypes for the Session Server
+int serverMode(int argc, char *argv[]);
+#ifdef HAVE_EPOLL
+bool sessionStart(Session &session);
+void sessionMain();
+void sessionResume(Session &session);
+bool sessionRead(Session &session);
+bool sessionSend(Session &session, int poll);
+void sessionEnd(Session &session);
+#endif
+
+// Function Prototypes for the Trainer Store
+bool     initStore(const char *path, string &error);
+uint64_t trainerNameHash(const string &name);
+bool     storeOpen(TrainerStore &store, const char *path, string &error);
+bool     storeWriteHeader(TrainerStore &store);
+uint32_t storeAllocatePage(TrainerStore &store);
+void     storeFreePages(TrainerStore &store, const vector<uint32_t> &pages);
+bool     storeReadRecord(TrainerStore &store, uint32_t firstPage, string &bytes, StoreSlot &slot, vector<uint32_t> *pages);
+bool     storeWriteRecord(TrainerStore &store, const string &bytes, StoreSlot &slot);
+bool     storeDecodeRecord(const string &bytes, PlayerData &player, StoreSlot &slot, string &error);
+bool     storeReadBucket(TrainerStore &store, uint32_t bucket, StoreEntry &entry);
+string   storeEncodeBucket(uint64_t hash, uint32_t firstPage, const string &name);
+bool     storeProbe(TrainerStore &store, const string &name, StoreEntry &entry);
+bool     storeGrowIndex(TrainerStore &store);
+bool     storeFind(TrainerStore &store, const string &name, StoreEntry &entry);
+uint32_t storeList(TrainerStore &store, uint32_t fromBucket, int count, vector<StoreEntry> &entries);
+bool     storeLoad(TrainerStore &store, const StoreEntry &entry, PlayerData &player, StoreSlot &slot, string &error);
+bool     storeSave(TrainerStore &store, const PlayerData &player, StoreSlot &slot);
+
+// Function Prototypes for the Trainer Cache
+bool     cacheLoad(TrainerCache &cache, const StoreEntry &entry, PlayerData &player, string &error);
+bool     cacheStore(TrainerCache &cache, const PlayerData &player);
+int      cacheVictim(TrainerCache &cache);
+int      cacheWriteBack(TrainerCache &cache);
+bool     cacheWriteBackTrainer(TrainerCache &cache, const string &name);
+void     writeBackSaves();
+void     writeBackSave(const string &name);
+
+// Function Prototypes for UI Systems
+void getPokemonIcon(PokemonSpecies species, ostream &out = screen);
+
+void drawHealthUI(int hp, int max, ostream &out = screen);
+void drawBattleUIHeader(PokemonData &attackingPokemon, ostream &out = screen);
+void drawBattleUIFooter(MenuLocation location, PlayerData &trainer, ostream &out = screen);
+void drawBattleUIStatus(PokemonData &attackingPokemon, string_view text);
+void drawBattleUI(PlayerData &trainer, PokemonData &attackingPokemon, MenuLocation location);
+void drawBattleEvent(BattleState &battle, BattleEvent &event);
+
+bool battleUIController(MenuLocation &location, int menuSelection, BattleAction &action);
+
+void printMenuStatistics(const BattleMenuStatistics &statistics);
+
+// Function Prototypes for Latency Statistics
+bool parseLatencyObjective(const string &text, LatencyObjective &objective);
+void addSaveLatency(LatencyStatistics &latency);
+void printLatencyStatistics(const LatencyStatistics &latency);
+bool checkLatencyObjectives(const LatencyStatistics &latency);
+
+// Function Prototypes for the Profiler
+#ifdef POKEMON_PROFILE
+void initProfiler();
+void printProfile(ostream &out);
+void printProfileAtExit();
+#endif
+
+// Function Prototypes for Menu Systems
+Status confirmStarterSelection(PlayerData &trainer, int selection);
+void   selectStarterPokemon(PlayerData &trainer);
+void   newGame(PlayerData &trainer);
+void   newGame(PlayerData &trainer);
+
+// Function Prototypes for Shop Systems
+void   pokemonCenter(PlayerData &trainer);
+int    pokemonCenterCost(int health, int maxHealth);
+Status pokemonCenterHeal(PlayerData &trainer, int pokemonToHeal);
+void   pokemonMart(PlayerData &trainer);
+Status pokemonMartItem(PlayerData &trainer, int item);
+
+// Function Prototypes for the Battle Core (No I/O, safe to run without a UI)
+BattleState  createWildBattle(PlayerData &trainer, RandomStream random);
+BattleEvents beginBattle(BattleState &battle);
+BattleEvents resolveTurn(BattleState &battle, BattleAction action);
+int          battleRoll(BattleState &battle, int range);
+int          attackPower(BattleState &battle, int level, Status attackType);
+void         computerAttack(BattleState &battle, BattleEvents &events);
+void         trainerAttack(BattleState &battle, Status attackType, BattleEvents &events);
+void         useElixir(BattleState &battle, BattleEvents &events);
+void         throwPokeball(BattleState &battle, BattleEvents &events);
+void         swapPokemon(BattleState &battle, int slot, BattleEvents &events);
+void         fleeBattle(BattleState &battle, BattleEvents &events);
+void         playerWin(BattleState &battle, BattleEvents &events);
+void         computerWin(BattleState &battle, BattleEvents &events);
+
+// Function Prototypes for Battle Simulation
+BattleAction     simulatedAction(BattleState &battle);
+void             simulateBattle(const PlayerData &templateTrainer, RandomStream random, SimulationResult &result);
+SimulationResult simulateBattles(const SimulationConfig &config);
+PlayerData       simulationTrainer(const SimulationConfig &config);
+int              simulateMode(int argc, char *argv[]);
+
+// Function Prototypes for Batch Simulation
+bool             cpuSupports(const string &isa);
+DamageKernel     damageKernelByName(const string &name);
+string           damageKernelName(DamageKernel kernel);
+void             rollBatchAttacks(BattleBatch &batch, vector<int32_t> &rolls, bool isComputer);
+void             initBattleBatch(BattleBatch &batch, const PokemonData &pokemon, int count, RandomStream random);
+int              resolveBatchTurn(BattleBatch &batch);
+SimulationResult simulateBatchBattles(const SimulationConfig &config);
+
+// Function Prototypes for Combat Systems
+void deadPickNew(PlayerData &trainer);
+void pokemonBattleSetup(PlayerData &trainer);
+
+// Function Prototypes for Battle Coroutines
+BattleTask       playBattle(BattleState &battle, BattleInput &input);
+BattleTask       switchBattle(BattleInput &input);
+bool             scriptedBattleInput(BattleSession &session);
+SimulationResult simulateCoroutineBattles(const SimulationConfig &config, CoroutineBenchmark &benchmark);
+double           measureCoroutineSwitch(long long switches);
+double           measureFiberSwitch(long long switches);
+size_t           residentBytes();
+
+// Function Prototypes for the Benchmark Suite
+int             benchMode(int argc, char *argv[]);
+BenchmarkResult runBenchmark(const Benchmark &benchmark, const BenchmarkConfig &config);
+long long       playBenchmarkBattles(const PlayerData &trainer, uint64_t seed, long long battles);
+void            writeBenchmarkJson(ostream &out, const BenchmarkConfig &config, const vector<BenchmarkResult> &results);
+string          benchmarkSpriteFile();
+
+// Function Prototypes for Main Game Loops
+void   mainBattleLoop(BattleState &battle);
+void   mainGameLoop(PlayerData &trainer);
+void   mainMenu(PlayerData &trainer);
+Status selectSavedTrainer(StoreEntry &entry);
+
+// *******************************************
+//           main
+//    COMPLETE STARTING POINT
+//********************************************
+int main(int argc, char *argv[])
+{
+	// Build Step (Generates the Embedded Sprite Header)
+	if (argc > 1 && string(argv[1]) == "embed-sprites")
+	{
+		return embedSpritesMode(argc, argv);
+	}
+
+	// Must Be Called On Initial Load
+	initGame();
+
+	// Command Line Options (--seed, --rng)
+	if (!initOptions(argc, argv))
+	{
+		return 1;
+	}
+
+	// Headless Battle Simulation
+	if (argc > 1 && string(argv[1]) == "simulate")
+	{
+		return simulateMode(argc, argv);
+	}
+
+	// Legacy save.txt Archive Import
+	if (argc > 1 && string(argv[1]) == "ingest-saves")
+	{
+		return ingestSavesMode(argc, argv);
+	}
+
+	// Benchmark Suite (Opens a Trainer Store of its own)
+	if (argc > 1 && string(argv[1]) == "bench")
+	{
+		return benchMode(argc, argv);
+	}
+
+	// Open the Trainer Store
+	{
+		string error;
+
+		if (!initStore(storePath, error))
+		{
+			cout << "Could not open " << storePath << ": " << error << endl;
+			return 1;
+		}
+	}
+
+	// Headless Replay of a Recorded Script
+	if (argc > 1 && string(argv[1]) == "replay")
+	{
+		return replayMode(argc, argv);
+	}
+
+	// Many Players on a Local Socket
+	if (argc > 1 && string(argv[1]) == "server")
+	{
+		return serverMode(argc, argv);
+	}
+
+	// Create a PlayerData object
+	PlayerData newPlayer;
+
+	// Start Game (Until it is Exited or the Input Ends)
+	try
+	{
+		mainMenu(newPlayer);
+	}
+	catch (const InputClosed &)
+	{
+	}
+
+	// Finish Any Save Still Being Written
+	saveWorker.stop();
+
+	// Send Whatever is Left
+	terminal->output.present();
+
+	// Output Statistics (--output-stats)
+	if (showOutputStats)
+	{
+		cout << "Frames: " << consoleTerminal.output.frames << ", write() calls: " << consoleTerminal.output.writeCalls
+			<< ", most in one frame: " << consoleTerminal.output.maxFrameWrites << endl;
+		cout << "Saves: " << saveStats.saves << " (last " << saveStats.lastSaveBytes << " bytes in " << saveStats.lastSaveMicros
+			<< " us, " << saveStats.journalAppends << " journaled, " << saveStats.compactions << " compactions), loads: "
+			<< saveStats.loads << " (last in " << saveStats.lastLoadMicros << " us)" << endl;
+		cout << "Save requests: " << saveWorker.requested << ", coalesced: " << saveWorker.coalesced << endl;
+		cout << "Trainer cache: " << trainerCache.hits << " hits, " << trainerCache.misses << " misses, "
+			<< trainerCache.evictions << " evictions, " << trainerCache.writeBacks << " write backs, "
+			<< trainerCache.writeFailures << " failed writes" << endl;
+		printMenuStatistics(consoleMenuStatistics);
+	}
+
+	// Response Times (Always checked against --slo)
+	LatencyStatistics latency = consoleTerminal.latency;
+	addSaveLatency(latency);
+
+	if (showOutputStats)
+	{
+		printLatencyStatistics(latency);
+	}
+
+	return checkLatencyObjectives(latency) ? 0 : 2;
+}
+// *******************************************
+//           initGame
+//    Sets EVERYTHING UP
+//********************************************
+void initGame()
+{
+	// Background Saves go through the Trainer Cache
+	saveWorker.write = saveGame;
+	saveWorker.writeBack = writeBackSaves;
+	saveWorker.writeBackTrainer = writeBackSave;
+
+	// Pick a Seed for this Session (Replaced by --seed when replaying)
+	gameSeed = (static_cast<uint64_t>(time(NULL)) << 32) ^ static_cast<uint64_t>(chrono::steady_clock::now().time_since_epoch().count());
+
+#ifdef _WIN32
+	// Let the Windows Console understand ANSI Escape Codes (used by clear() and the Battle Screen)
+	HANDLE console = GetStdHandle(STD_OUTPUT_HANDLE);
+	DWORD mode = 0;
+	if (GetConsoleMode(console, &mode))
+	{
+		SetConsoleMode(console, mode | ENABLE_VIRTUAL_TERMINAL_PROCESSING);
+	}
+#endif
+
+	// Use the Widest Damage Kernel this CPU Supports
+	damageKernel = damageKernelByName("best");
+
+	// Species, Move and Item Tables are compiled in, only Sprites may need loading
+	initSprites(nullptr);
+
+#ifdef POKEMON_PROFILE
+	// Dump the Profile on Exit and on SIGUSR1 (Before any other Thread is Started)
+	initProfiler();
+#endif
+}
+// *******************************************
+//           initOptions
+//    Reads the options shared by every mode:
+//    --seed N     replay a session exactly
+//    --rng NAME   philox (default) or splitmix
+//    --simd NAME  avx2, sse4.2 or scalar
+//    --sprites PATH  load sprites from a file
+//    --cache-size N  trainers kept in memory
+//    --output-stats  print write() calls per
+//                    frame and save / load
+//                    times when the game ends
+//    --trace FILE    write a Chrome trace
+//    --trace-sample N  trace 1 in N sessions
+//    --slo METRIC:PERCENTILE:MICROSECONDS
+//                    latency objective, the
+//                    exit code is 2 if missed
+//********************************************
+bool initOptions(int argc, char *argv[])
+{
+	const char *recordPath = nullptr;
+	const char *tracePath = nullptr;
+
+	for (int i = 1; i < argc; i++)
+	{
+		string option = argv[i];
+
+		if (option == "--output-stats")
+		{
+			showOutputStats = true;
+			continue;
+		}
+
+		// Every other Option takes a Value
+		if (i + 1 >= argc)
+		{
+			break;
+		}
+
+		if (option == "--seed")
+		{
+			gameSeed = stoull(argv[i + 1]);
+		}
+		else if (option == "--rng")
+		{
+			RandomBlockFunction engine = randomEngineByName(argv[i + 1]);
+
+			if (engine == nullptr)
+			{
+				cout << "Unknown random engine: " << argv[i + 1] << " (expected philox or splitmix)" << endl;
+				return false;
+			}
+
+			randomEngine = engine;
+		}
+		else if (option == "--sprites")
+		{
+			if (!initSprites(argv[i + 1]))
+			{
+				cout << "Could not read sprites from " << argv[i + 1] << endl;
+				return false;
+			}
+		}
+		else if (option == "--cache-size")
+		{
+			trainerCache.resize(stoi(argv[i + 1]));
+		}
+		else if (option == "--store")
+		{
+			storePath = argv[i + 1];
+		}
+		else if (option == "--script")
+		{
+			// Play from a Script instead of the Keyboard (with the Seed it was recorded with)
+			if (!scriptInput.open(argv[i + 1]))
+			{
+				cout << "Could not read " << argv[i + 1] << endl;
+				return false;
+			}
+
+			if (scriptInput.hasSeed)
+			{
+				gameSeed = scriptInput.seed;
+			}
+
+			consoleTerminal.input.rdbuf(&scriptInput);
+		}
+		else if (option == "--record")
+		{
+			recordPath = argv[i + 1];
+		}
+		else if (option == "--trace")
+		{
+			tracePath = argv[i + 1];
+		}
+		else if (option == "--trace-sample")
+		{
+			tracer.sample = max(1, stoi(argv[i + 1]));
+		}
+		else if (option == "--slo")
+		{
+			LatencyObjective objective;
+
+			if (!parseLatencyObjective(argv[i + 1], objective))
+			{
+				cout << "Bad latency objective: " << argv[i + 1] << " (expected METRIC:PERCENTILE:MICROSECONDS, e.g. input-to-frame:99.9:500)" << endl;
+				return false;
+			}
+
+			latencyObjectives.push_back(objective);
+		}
+		else if (option == "--simd")
+		{
+			DamageKernel kernel = damageKernelByName(argv[i + 1]);
+
+			if (kernel == nullptr)
+			{
+				cout << "Damage kernel not available on this CPU: " << argv[i + 1] << endl;
+				return false;
+			}
+
+			damageKernel = kernel;
+		}
+	}
+
+	// Record Whatever the Console Reads (Once the Seed is Known)
+	if (recordPath != nullptr)
+	{
+		recordingInput.source = static_cast<InputSource *>(consoleTerminal.input.rdbuf());
+
+		if (!recordingInput.open(recordPath, gameSeed))
+		{
+			cout << "Could not write " << recordPath << endl;
+			return false;
+		}
+
+		consoleTerminal.input.rdbuf(&recordingInput);
+	}
+
+	// Trace this Session (and Sessions Served Later) if it is in the Sample
+	if (tracePath != nullptr)
+	{
+		if (!tracer.start(tracePath))
+		{
+			cout << "Could not write " << tracePath << endl;
+			return false;
+		}
+
+		consoleTerminal.traceTrack = tracer.sampleTrack("console");
+	}
+
+	return true;
+}
+// *******************************************
+//           initSprites
+//    Points the Sprite Atlas at the sprites
+//    compiled into the game, or loads them
+//    from a file (pokemon.txt by default, or
+//    --sprites PATH for modded sprites).
+//********************************************
+bool initSprites(const char *path)
+{
+#ifdef HAVE_EMBEDDED_SPRITES
+	// No File Given, use the Compiled-in Sprites
+	if (path == nullptr)
+	{
+		spriteAtlas.useEmbedded(EMBEDDED_SPRITES, sizeof(EMBEDDED_SPRITES) - 1, EMBEDDED_SPRITE_LINE_START, EMBEDDED_SPRITE_LINES);
+		return true;
+	}
+#endif
+
+	return spriteAtlas.load(path != nullptr ? path : "pokemon.txt");
+}
+// *******************************************
+//           embedSpritesMode
+//    Build step that turns a sprite file into
+//    a header of constexpr tables:
+//    embed-sprites pokemon.txt PokemonSprites.h
+//    Rebuilding with the header next to the
+//    source compiles the sprites into the game.
+//********************************************
+int embedSpritesMode(int argc, char *argv[])
+{
+	if (argc < 4)
+	{
+		cout << "Usage: embed-sprites <pokemon.txt> <PokemonSprites.h>" << endl;
+		return 1;
+	}
+
+	// Read the Sprite File
+	SpriteAtlas atlas;
+	if (!atlas.load(argv[2]))
+	{
+		cout << "Could not read " << argv[2] << endl;
+		return 1;
+	}
+
+	ofstream header(argv[3], ios::out | ios::binary);
+	if (!header)
+	{
+		cout << "Could not write " << argv[3] << endl;
+		return 1;
+	}
+
+	header << "// Generated by \"embed-sprites\" from " << argv[2] << ". Do not edit." << endl;
+	header << "#pragma once" << endl << endl;
+
+	// Sprite Text, one String Literal per Line
+	header << "constexpr char EMBEDDED_SPRITES[] =" << endl;
+	for (size_t line = 0; line < atlas.lines(); line++)
+	{
+		string_view text = atlas.view(static_cast<int>(line), static_cast<int>(line + 1));
+
+		header << "\t\"";
+		for (char c : text)
+		{
+			unsigned char u = static_cast<unsigned char>(c);
+
+			if (c == '\\' || c == '"' || c == '?')
+			{
+				header << '\\' << c;
+			}
+			else if (c == '\n')
+			{
+				header << "\\n";
+			}
+			else if (u < 32 || u > 126)
+			{
+				// Always 3 Octal Digits so the next character can't extend the escape
+				header << '\\' << static_cast<char>('0' + (u >> 6)) << static_cast<char>('0' + ((u >> 3) & 7)) << static_cast<char>('0' + (u & 7));
+			}
+			else
+			{
+				header << c;
+			}
+		}
+		header << "\"" << endl;
+	}
+	header << "\t\"\";" << endl << endl;
+
+	// Line Offsets (Already indexed, so startup does no work)
+	header << "constexpr size_t EMBEDDED_SPRITE_LINES = " << atlas.lines() << ";" << endl;
+	header << "constexpr size_t EMBEDDED_SPRITE_LINE_START[] = {";
+	for (size_t line = 0; line <= atlas.lines(); line++)
+	{
+		header << ((line % 12 == 0) ? "\n\t" : " ") << atlas.lineStart[line] << ",";
+	}
+	header << endl << "};" << endl;
+
+	cout << "Embedded " << atlas.lines() << " sprite lines (" << atlas.size << " bytes) into " << argv[3] << endl;
+
+	return 0;
+}
+// *******************************************
+//           getPokemonIcon
+//    This function retrieves the pokemon
+//		sprite data and prints it out to the
+//    console.
+//********************************************
+void getPokemonIcon(PokemonSpecies species, ostream &out)
+{
+	speciesData[species].printIcon(out);
+}
+// *******************************************
+//           displayData
+//    Displays Player Data to Console (Debug)
+//********************************************
+void displayData(PlayerData player)
+{
+	screen << player.name << endl;
+	screen << player.rivalName << endl;
+	screen << player.money << endl;
+	screen << player.pokemonOwned << endl << endl;
+
+	// Item Information
+	for (int i = 0; i < ITEMS_IN_GAME; i++)
+	{
+		screen << itemData[i].name << " : " << player.itemsOwned[i] << endl;
+	}
+
+	screen << endl;
+
+	// Pokemon Information
+	for (int i = 0; i < player.pokemonOwned; i++)
+	{
+		screen << player.pokemon[i].name() << endl;
+		screen << player.pokemon[i].health << endl;
+		screen << player.pokemon[i].level << endl;
+		screen << player.pokemon[i].exp << endl;
+		screen << static_cast<int>(player.pokemon[i].species) << endl;
+		screen << player.pokemon[i].isDead << endl;
+		screen << player.pokemon[i].maxHealth << endl;
+		getPokemonIcon(player.pokemon[i].species);
+		screen << endl;
+	}
+}
+// *******************************************
+//           saveGame
+//    Saves the Player into the Trainer Cache.
+//    Only what changed since the last write
+//    is later appended to the trainer's
+//    record in the store.
+//********************************************
+void saveGame(const PlayerData &player)
+{
+	PROFILE_SCOPE(PROFILE_SAVE_GAME);
+	TraceSpan span("saveGame");
+	LatencyTimer timer(saveStats.saveLatency);
+
+	auto start = chrono::steady_clock::now();
+
+	// A Failed Write is Counted by the Cache (failed writes), not as a Save
+	if (!cacheStore(trainerCache, player))
+	{
+		return;
+	}
+
+	// Keep Count
+	saveStats.saves++;
+	saveStats.lastSaveMicros = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start).count();
+}
+// *******************************************
+//           loadGame
+//    Reads a Trainer picked from the Store
+//    (Through the Trainer Cache).
+//    Returns FAILED with the reason in error
+//    if the record can't be used.
+//********************************************
+Status loadGame(const StoreEntry &entry, PlayerData &player, string &error)
+{
+	PROFILE_SCOPE(PROFILE_LOAD_GAME);
+	TraceSpan span("loadGame");
+
+	auto start = chrono::steady_clock::now();
+
+	if (!cacheLoad(trainerCache, entry, player, error))
+	{
+		return FAILED;
+	}
+
+	// Keep Count
+	saveStats.loads++;
+	saveStats.lastLoadMicros = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start).count();
+
+	return SUCCESS;
+}
+// *******************************************
+//           cacheLoad
+//    Gets a Trainer from the Trainer Cache,
+//    loading it from the store on a miss
+//********************************************
+bool cacheLoad(TrainerCache &cache, const StoreEntry &entry, PlayerData &player, string &error)
+{
+	lock_guard<mutex> guard(cache.lock);
+
+	// Hit (Names longer than the index prefix are only known after loading)
+	auto found = entry.partialName ? cache.index.end() : cache.index.find(entry.name);
+
+	// Miss
+	PlayerData loaded;
+	StoreSlot slot;
+
+	if (found == cache.index.end())
+	{
+		if (!storeLoad(trainerStore, entry, loaded, slot, error))
+		{
+			return false;
+		}
+
+		found = cache.index.find(loaded.name);
+	}
+
+	if (found != cache.index.end())
+	{
+		// The Cached Copy may be Newer than the Store
+		TrainerCache::Entry &hit = cache.entries[found->second];
+		hit.referenced = true;
+		player = hit.current;
+
+		cache.hits++;
+		return true;
+	}
+
+	// Every Entry holds a Trainer that can't be Written, hand this one out Uncached
+	int at = cacheVictim(cache);
+	if (at < 0)
+	{
+		player = loaded;
+		cache.misses++;
+		return true;
+	}
+
+	TrainerCache::Entry &added = cache.entries[at];
+	added.current = loaded;
+	added.slot = slot;
+	added.used = true;
+	added.dirty = false;
+	added.referenced = true;
+	cache.index[loaded.name] = at;
+
+	player = loaded;
+
+	cache.misses++;
+	return true;
+}
+// *******************************************
+//           cacheStore
+//    Puts a Trainer in the Trainer Cache and
+//    marks it dirty. It reaches the store on
+//    the next write back or when evicted.
+//    With no entry to evict it is written to
+//    the store at once. Returns false if that
+//    write failed.
+//********************************************
+bool cacheStore(TrainerCache &cache, const PlayerData &player)
+{
+	lock_guard<mutex> guard(cache.lock);
+
+	auto found = cache.index.find(player.name);
+
+	if (found != cache.index.end())
+	{
+		TrainerCache::Entry &hit = cache.entries[found->second];
+		hit.current = player;
+		hit.dirty = true;
+		hit.referenced = true;
+
+		cache.hits++;
+		return true;
+	}
+
+	// Not Cached (The store is asked what it has for the trainer when it is written)
+	int at = cacheVictim(cache);
+	if (at < 0)
+	{
+		// No Room: Write it Straight to the Store instead
+		StoreSlot slot;
+		if (!storeSave(trainerStore, player, slot))
+		{
+			cache.writeFailures++;
+			return false;
+		}
+
+		cache.writeBacks++;
+		cache.misses++;
+		return true;
+	}
+
+	TrainerCache::Entry &added = cache.entries[at];
+	added.current = player;
+	added.slot = StoreSlot();
+	added.used = true;
+	added.dirty = true;
+	added.referenced = true;
+	cache.index[player.name] = at;
+
+	cache.misses++;
+	return true;
+}
+// *******************************************
+//           cacheVictim
+//    Frees an entry with the CLOCK hand and
+//    returns it. A dirty victim is written to
+//    the store first, and stays cached if that
+//    fails. Returns -1 if no entry could be
+//    freed. (Caller holds the lock)
+//********************************************
+int cacheVictim(TrainerCache &cache)
+{
+	// Two Laps clear every Referenced bit, a Third finds a Victim if any Write can Succeed
+	int size = static_cast<int>(cache.entries.size());
+	for (int tries = 0; tries < 3 * size; tries++)
+	{
+		int at = cache.hand;
+		TrainerCache::Entry &entry = cache.entries[at];
+		cache.hand = (cache.hand + 1) % static_cast<int>(cache.entries.size());
+
+		if (!entry.used)
+		{
+			return at;
+		}
+
+		// Recently Used, Give it Another Lap
+		if (entry.referenced)
+		{
+			entry.referenced = false;
+			continue;
+		}
+
+		// Unsaved Progress is only Dropped once it is in the Store
+		if (entry.dirty)
+		{
+			if (!storeSave(trainerStore, entry.current, entry.slot))
+			{
+				cache.writeFailures++;
+				continue;
+			}
+
+			cache.writeBacks++;
+		}
+
+		// Evict
+		cache.index.erase(entry.current.name);
+		entry.used = false;
+		entry.dirty = false;
+		cache.evictions++;
+
+		return at;
+	}
+
+	return -1;
+}
+// *******************************************
+//           cacheWriteBack
+//    Writes every dirty Trainer to the store.
+//    Returns how many were written.
+//********************************************
+int cacheWriteBack(TrainerCache &cache)
+{
+	lock_guard<mutex> guard(cache.lock);
+
+	int written = 0;
+
+	for (TrainerCache::Entry &entry : cache.entries)
+	{
+		if (entry.used && entry.dirty && storeSave(trainerStore, entry.current, entry.slot))
+		{
+			entry.dirty = false;
+			written++;
+		}
+	}
+
+	cache.writeBacks += written;
+	return written;
+}
+// *******************************************
+//           cacheWriteBackTrainer
+//    Writes one Trainer to the store if it is
+//    cached and dirty. Returns if it was.
+//********************************************
+bool cacheWriteBackTrainer(TrainerCache &cache, const string &name)
+{
+	lock_guard<mutex> guard(cache.lock);
+
+	auto found = cache.index.find(name);
+
+	if (found == cache.index.end())
+	{
+		return false;
+	}
+
+	TrainerCache::Entry &entry = cache.entries[found->second];
+
+	if (!entry.dirty || !storeSave(trainerStore, entry.current, entry.slot))
+	{
+		return false;
+	}
+
+	entry.dirty = false;
+	cache.writeBacks++;
+	return true;
+}
+// *******************************************
+//           writeBackSaves
+//    Sends every dirty cached Trainer to the
+//    Trainer Store (Used by the Save Worker)
+//********************************************
+void writeBackSaves()
+{
+	cacheWriteBack(trainerCache);
+}
+// *******************************************
+//           writeBackSave
+//    Sends one cached Trainer to the Trainer
+//    Store (Used by the Save Worker)
+//********************************************
+void writeBackSave(const string &name)
+{
+	cacheWriteBackTrainer(trainerCache, name);
+}
+// *******************************************
+//           initStore
+//    Opens the Trainer Store and brings in
+//    the trainer from an old save.dat or
+//    save.txt if the store doesn't have it
+//********************************************
+bool initStore(const char *path, string &error)
+{
+	if (!storeOpen(trainerStore, path, error))
+	{
+		return false;
+	}
+
+	// Import the Single Save Slot of Older Versions
+	PlayerData player;
+	string bytes;
+	bool found = false;
+
+	if (readWholeFile(SAVE_FILE, bytes))
+	{
+		string ignored;
+		found = decodeSave(bytes, player, ignored);
+
+		// Continue with its save.journal if it belongs to this save.dat
+		string journal;
+		if (found && readWholeFile(SAVE_JOURNAL_FILE, journal) && journal.size() >= SAVE_JOURNAL_HEADER_SIZE &&
+			journal.compare(0, 4, SAVE_JOURNAL_MAGIC, 4) == 0 && SaveReader(journal).u32(8) == SaveReader(bytes).u32(16))
+		{
+			replayJournalFrames(journal, SAVE_JOURNAL_HEADER_SIZE, player);
+		}
+	}
+	else
+	{
+		LegacyParseError ignored;
+		found = loadLegacyGame(LEGACY_SAVE_FILE, player, ignored);
+	}
+
+	StoreEntry entry;
+	StoreSlot slot;
+	if (found && !storeFind(trainerStore, player.name, entry))
+	{
+		storeSave(trainerStore, player, slot);
+	}
+
+	return true;
+}
+// *******************************************
+//           trainerNameHash
+//    64 bit FNV-1a of a Trainer's name (The
+//    key of the Trainer Store index)
+//********************************************
+uint64_t trainerNameHash(const string &name)
+{
+	uint64_t hash = 14695981039346656037ull;
+
+	for (unsigned char c : name)
+	{
+		hash = (hash ^ c) * 1099511628211ull;
+	}
+
+	return hash;
+}
+// *******************************************
+//           storeOpen
+//    Opens or creates a Trainer Store file
+//********************************************
+bool storeOpen(TrainerStore &store, const char *path, string &error)
+{
+	lock_guard<mutex> guard(store.lock);
+
+#ifdef HAVE_POSIX
+	store.file = open(path, O_RDWR | O_CREAT, 0644);
+	if (store.file < 0)
+	{
+		error = strerror(errno);
+		return false;
+	}
+#else
+	store.file.open(path, ios::in | ios::out | ios::binary);
+	if (!store.file)
+	{
+		ofstream(path, ios::out | ios::binary);
+		store.file.open(path, ios::in | ios::out | ios::binary);
+	}
+
+	if (!store.file)
+	{
+		error = "could not open file";
+		return false;
+	}
+#endif
+
+	unsigned char header[32];
+	uint64_t length = store.size();
+
+	if (length == 0)
+	{
+		// New Store (Header, then an empty Index)
+		store.bucketCount = STORE_INITIAL_BUCKETS;
+		store.indexPage = 1;
+		store.pageCount = 1 + STORE_INITIAL_BUCKETS / STORE_BUCKETS_PER_PAGE;
+		store.trainerCount = 0;
+		store.freeHead = 0;
+
+		string empty(static_cast<size_t>(store.pageCount - 1) * STORE_PAGE_SIZE, '\0');
+		if (!store.writeAt(store.pageOffset(1), empty.data(), empty.size()) || !storeWriteHeader(store))
+		{
+			error = "could not write header";
+			return false;
+		}
+
+		store.isOpen = true;
+		return true;
+	}
+
+	// Existing Store (Anything shorter than a header is damaged, not new)
+	if (length < sizeof(header) || !store.readAt(0, header, sizeof(header)))
+	{
+		error = "truncated trainer store";
+		return false;
+	}
+
+	string bytes(reinterpret_cast<char *>(header), sizeof(header));
+	SaveReader in(bytes);
+
+	if (bytes.compare(0, 4, STORE_MAGIC, 4) != 0 || crc32c(header, 28) != in.u32(28))
+	{
+		error = "not a trainer store";
+		return false;
+	}
+
+	if (in.u16(4) > STORE_VERSION || in.u16(6) != STORE_PAGE_SIZE)
+	{
+		error = "written by a newer version";
+		return false;
+	}
+
+	store.pageCount = in.u32(8);
+	store.trainerCount = in.u32(12);
+	store.bucketCount = in.u32(16);
+	store.indexPage = in.u32(20);
+	store.freeHead = in.u32(24);
+	store.isOpen = true;
+
+	return true;
+}
+// *******************************************
+//           storeWriteHeader
+//    Writes page 0 (Caller holds the lock)
+//********************************************
+bool storeWriteHeader(TrainerStore &store)
+{
+	SaveWriter out;
+	out.bytes.append(STORE_MAGIC, 4);
+	out.u16(STORE_VERSION);
+	out.u16(STORE_PAGE_SIZE);
+	out.u32(store.pageCount);
+	out.u32(store.trainerCount);
+	out.u32(store.bucketCount);
+	out.u32(store.indexPage);
+	out.u32(store.freeHead);
+	out.u32(crc32c(out.bytes.data(), out.bytes.size()));
+
+	return store.writeAt(0, out.bytes.data(), out.bytes.size());
+}
+// *******************************************
+//           storeAllocatePage
+//    Takes a page off the free list, or grows
+//    the file. The header must be written
+//    before the page is used.
+//********************************************
+uint32_t storeAllocatePage(TrainerStore &store)
+{
+	if (store.freeHead != 0)
+	{
+		uint32_t page = store.freeHead;
+		unsigned char next[4];
+
+		if (store.readAt(store.pageOffset(page), next, 4))
+		{
+			store.freeHead = next[0] | (next[1] << 8) | (next[2] << 16) | (static_cast<uint32_t>(next[3]) << 24);
+			return page;
+		}
+
+		// Unreadable Free List, Leave it Behind
+		store.freeHead = 0;
+	}
+
+	return store.pageCount++;
+}
+// *******************************************
+//           storeFreePages
+//    Puts pages on the free list. The header
+//    must be written afterwards.
+//********************************************
+void storeFreePages(TrainerStore &store, const vector<uint32_t> &pages)
+{
+	for (uint32_t page : pages)
+	{
+		SaveWriter next;
+		next.u32(store.freeHead);
+
+		if (store.writeAt(store.pageOffset(page), next.bytes.data(), 4))
+		{
+			store.freeHead = page;
+		}
+	}
+}
+// *******************************************
+//           storeReadRecord
+//    Reads the data of a page chain and where
+//    it ends (Caller holds the lock)
+//********************************************
+bool storeReadRecord(TrainerStore &store, uint32_t firstPage, string &bytes, StoreSlot &slot, vector<uint32_t> *pages)
+{
+	unsigned char page[STORE_PAGE_SIZE];
+	uint32_t current = firstPage;
+
+	bytes.clear();
+
+	// A Chain can't be Longer than the File
+	for (uint32_t steps = 0; current != 0 && steps < store.pageCount; steps++)
+	{
+		if (current >= store.pageCount || !store.readAt(store.pageOffset(current), page, STORE_PAGE_SIZE))
+		{
+			return false;
+		}
+
+		uint32_t next = page[0] | (page[1] << 8) | (page[2] << 16) | (static_cast<uint32_t>(page[3]) << 24);
+		uint32_t used = page[4] | (page[5] << 8);
+
+		if (used > STORE_PAGE_DATA_SIZE)
+		{
+			return false;
+		}
+
+		bytes.append(reinterpret_cast<char *>(page) + STORE_PAGE_HEADER_SIZE, used);
+
+		if (pages != nullptr)
+		{
+			pages->push_back(current);
+		}
+
+		slot.lastPage = current;
+		slot.lastUsed = used;
+		current = next;
+	}
+
+	slot.firstPage = firstPage;
+	return current == 0;
+}
+// *******************************************
+//           storeWriteRecord
+//    Writes bytes into a new page chain
+//    (Caller holds the lock)
+//********************************************
+bool storeWriteRecord(TrainerStore &store, const string &bytes, StoreSlot &slot)
+{
+	// Allocate every Page and Persist the Allocation First
+	size_t pageTotal = max<size_t>(1, (bytes.size() + STORE_PAGE_DATA_SIZE - 1) / STORE_PAGE_DATA_SIZE);
+	vector<uint32_t> pages(pageTotal);
+
+	for (size_t i = 0; i < pageTotal; i++)
+	{
+		pages[i] = storeAllocatePage(store);
+	}
+
+	if (!storeWriteHeader(store))
+	{
+		return false;
+	}
+
+	// Fill the Pages
+	SaveWriter page;
+
+	for (size_t i = 0; i < pageTotal; i++)
+	{
+		size_t at = i * STORE_PAGE_DATA_SIZE;
+		size_t used = min<size_t>(STORE_PAGE_DATA_SIZE, bytes.size() - at);
+
+		page.bytes.clear();
+		page.u32((i + 1 < pageTotal) ? pages[i + 1] : 0);
+		page.u16(static_cast<uint16_t>(used));
+		page.u16(0);
+		page.bytes.append(bytes, at, used);
+		page.bytes.resize(STORE_PAGE_SIZE, '\0');
+
+		if (!store.writeAt(store.pageOffset(pages[i]), page.bytes.data(), page.bytes.size()))
+		{
+			return false;
+		}
+
+		slot.lastUsed = static_cast<uint32_t>(used);
+	}
+
+	slot.firstPage = pages.front();
+	slot.lastPage = pages.back();
+	return true;
+}
+// *******************************************
+//           storeDecodeRecord
+//    Snapshot plus journal frames of a record
+//    into a Player
+//********************************************
+bool storeDecodeRecord(const string &bytes, PlayerData &player, StoreSlot &slot, string &error)
+{
+	if (bytes.size() < SAVE_HEADER_SIZE)
+	{
+		error = "record is truncated";
+		return false;
+	}
+
+	SaveReader in(bytes);
+	size_t snapshotLength = static_cast<size_t>(in.u32(8)) + in.u32(12);
+
+	if (snapshotLength > bytes.size() || !decodeSave(bytes.substr(0, snapshotLength), player, error))
+	{
+		if (error.empty())
+		{
+			error = "record is truncated";
+		}
+		return false;
+	}
+
+	// Bring it Up to Date (Anything after a bad frame is dropped at the next compaction)
+	size_t end = replayJournalFrames(bytes, snapshotLength, player);
+
+	slot.saved = player;
+	slot.journalBytes = end - snapshotLength;
+	slot.needsCompaction = end != bytes.size();
+
+	return true;
+}
+// *******************************************
+//           storeReadBucket
+//    Reads one bucket of the index
+//********************************************
+bool storeReadBucket(TrainerStore &store, uint32_t bucket, StoreEntry &entry)
+{
+	string bytes(STORE_BUCKET_SIZE, '\0');
+
+	if (!store.readAt(store.bucketOffset(bucket), &bytes[0], STORE_BUCKET_SIZE))
+	{
+		return false;
+	}
+
+	SaveReader in(bytes);
+	uint32_t nameLength = in.u8(12);
+
+	entry.bucket = bucket;
+	entry.hash = static_cast<uint64_t>(in.u32(0)) | (static_cast<uint64_t>(in.u32(4)) << 32);
+	entry.firstPage = in.u32(8);
+	entry.partialName = nameLength > STORE_NAME_PREFIX;
+	entry.name.assign(bytes, 13, min(nameLength, STORE_NAME_PREFIX));
+
+	return true;
+}
+// *******************************************
+//           storeEncodeBucket
+//    The 32 bytes of a bucket
+//********************************************
+string storeEncodeBucket(uint64_t hash, uint32_t firstPage, const string &name)
+{
+	SaveWriter out;
+	out.u32(static_cast<uint32_t>(hash));
+	out.u32(static_cast<uint32_t>(hash >> 32));
+	out.u32(firstPage);
+	out.u8(static_cast<uint8_t>(min<size_t>(name.size(), 255)));
+	out.bytes.append(name, 0, STORE_NAME_PREFIX);
+	out.bytes.resize(STORE_BUCKET_SIZE, '\0');
+
+	return out.bytes;
+}
+// *******************************************
+//           storeProbe
+//    Finds a Trainer's bucket. If it isn't
+//    there, entry is the empty bucket it
+//    would go in. (Caller holds the lock)
+//********************************************
+bool storeProbe(TrainerStore &store, const string &name, StoreEntry &entry)
+{
+	uint64_t hash = trainerNameHash(name);
+	uint32_t mask = store.bucketCount - 1;
+	uint32_t bucket = static_cast<uint32_t>(hash) & mask;
+
+	for (uint32_t i = 0; i < store.bucketCount; i++, bucket = (bucket + 1) & mask)
+	{
+		if (!storeReadBucket(store, bucket, entry))
+		{
+			return false;
+		}
+
+		if (entry.firstPage == 0)
+		{
+			return false;
+		}
+
+		if (entry.hash != hash || name.compare(0, STORE_NAME_PREFIX, entry.name) != 0)
+		{
+			continue;
+		}
+
+		if (!entry.partialName)
+		{
+			if (name.size() == entry.name.size())
+			{
+				return true;
+			}
+			continue;
+		}
+
+		// Long Names are Checked against the Record
+		string bytes;
+		StoreSlot slot;
+		PlayerData player;
+		string error;
+
+		if (storeReadRecord(store, entry.firstPage, bytes, slot, nullptr) && storeDecodeRecord(bytes, player, slot, error) && player.name == name)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+// *******************************************
+//           storeGrowIndex
+//    Doubles the index into new pages, then
+//    frees the old ones (Caller holds lock)
+//********************************************
+bool storeGrowIndex(TrainerStore &store)
+{
+	uint32_t newCount = store.bucketCount * 2;
+	uint32_t newPages = newCount / STORE_BUCKETS_PER_PAGE;
+	uint32_t oldPages = store.bucketCount / STORE_BUCKETS_PER_PAGE;
+	string index(static_cast<size_t>(newCount) * STORE_BUCKET_SIZE, '\0');
+
+	// Rehash every Bucket (The Index is Contiguous, so it goes at the End of the File)
+	string old(static_cast<size_t>(oldPages) * STORE_PAGE_SIZE, '\0');
+	if (!store.readAt(store.pageOffset(store.indexPage), &old[0], old.size()))
+	{
+		return false;
+	}
+
+	for (uint32_t bucket = 0; bucket < store.bucketCount; bucket++)
+	{
+		size_t from = static_cast<size_t>(bucket) * STORE_BUCKET_SIZE;
+		SaveReader in(old);
+
+		if (in.u32(from + 8) == 0)
+		{
+			continue;
+		}
+
+		uint64_t hash = static_cast<uint64_t>(in.u32(from)) | (static_cast<uint64_t>(in.u32(from + 4)) << 32);
+		uint32_t target = static_cast<uint32_t>(hash) & (newCount - 1);
+
+		while (SaveReader(index).u32(static_cast<size_t>(target) * STORE_BUCKET_SIZE + 8) != 0)
+		{
+			target = (target + 1) & (newCount - 1);
+		}
+
+		index.replace(static_cast<size_t>(target) * STORE_BUCKET_SIZE, STORE_BUCKET_SIZE, old, from, STORE_BUCKET_SIZE);
+	}
+
+	uint32_t newIndexPage = store.pageCount;
+	uint32_t oldIndexPage = store.indexPage;
+
+	store.pageCount += newPages;
+	if (!store.writeAt(store.pageOffset(newIndexPage), index.data(), index.size()))
+	{
+		store.pageCount -= newPages;
+		return false;
+	}
+
+	// Switch to the New Index
+	store.indexPage = newIndexPage;
+	store.bucketCount = newCount;
+	if (!storeWriteHeader(store))
+	{
+		return false;
+	}
+
+	// Old Index Pages hold Records from now on
+	vector<uint32_t> pages;
+	for (uint32_t i = 0; i < oldPages; i++)
+	{
+		pages.push_back(oldIndexPage + i);
+	}
+
+	storeFreePages(store, pages);
+	return storeWriteHeader(store);
+}
+// *******************************************
+//           storeFind
+//    Looks a Trainer up by name
+//********************************************
+bool storeFind(TrainerStore &store, const string &name, StoreEntry &entry)
+{
+	lock_guard<mutex> guard(store.lock);
+
+	return store.isOpen && storeProbe(store, name, entry);
+}
+// *******************************************
+//           storeList
+//    Collects up to count Trainers starting
+//    at a bucket. Returns the bucket to carry
+//    on from, or 0 once the index is done.
+//********************************************
+uint32_t storeList(TrainerStore &store, uint32_t fromBucket, int count, vector<StoreEntry> &entries)
+{
+	lock_guard<mutex> guard(store.lock);
+
+	StoreEntry entry;
+	uint32_t bucket = fromBucket;
+
+	for (; store.isOpen && bucket < store.bucketCount && static_cast<int>(entries.size()) < count; bucket++)
+	{
+		if (storeReadBucket(store, bucket, entry) && entry.firstPage != 0)
+		{
+			entries.push_back(entry);
+		}
+	}
+
+	return (bucket < store.bucketCount) ? bucket : 0;
+}
+// *******************************************
+//           storeLoad
+//    Reads a Trainer's record into player
+//********************************************
+bool storeLoad(TrainerStore &store, const StoreEntry &entry, PlayerData &player, StoreSlot &slot, string &error)
+{
+	lock_guard<mutex> guard(store.lock);
+
+	string bytes;
+
+	if (!store.isOpen || !storeReadRecord(store, entry.firstPage, bytes, slot, nullptr))
+	{
+		error = "record is damaged";
+		return false;
+	}
+
+	if (!storeDecodeRecord(bytes, player, slot, error))
+	{
+		return false;
+	}
+
+	slot.known = true;
+	return true;
+}
+// *******************************************
+//           storeSave
+//    Appends the difference to the Trainer's
+//    record. Compacts into a new page chain
+//    when the journal is full or the change
+//    can't be journaled. slot is what the
+//    last load or save left behind (or a new
+//    StoreSlot if there wasn't one).
+//********************************************
+bool storeSave(TrainerStore &store, const PlayerData &player, StoreSlot &slot)
+{
+	lock_guard<mutex> guard(store.lock);
+	LatencyTimer timer(saveStats.storeWriteLatency);
+
+	if (!store.isOpen)
+	{
+		return false;
+	}
+
+	// What is on Disk for this Trainer
+	if (!slot.known)
+	{
+		StoreEntry entry;
+		string bytes;
+		string error;
+
+		slot = StoreSlot();
+
+		if (storeProbe(store, player.name, entry) && (!storeReadRecord(store, entry.firstPage, bytes, slot, nullptr) || !storeDecodeRecord(bytes, slot.saved, slot, error)))
+		{
+			slot.needsCompaction = true;
+		}
+
+		slot.known = true;
+	}
+
+	// Build the Frame (Records first, then length and checksum around them)
+	SaveWriter frame;
+	frame.u32(0);
+
+	if (slot.firstPage != 0 && !slot.needsCompaction && journalDelta(slot.saved, player, frame))
+	{
+		if (frame.bytes.size() == 4)
+		{
+			// Nothing Changed
+			saveStats.lastSaveBytes = 0;
+			return true;
+		}
+
+		frame.patch32(0, static_cast<uint32_t>(frame.bytes.size() - 4));
+		frame.u32(crc32c(frame.bytes.data(), frame.bytes.size()));
+
+		uint32_t size = static_cast<uint32_t>(frame.bytes.size());
+
+		if (slot.journalBytes + size <= SAVE_JOURNAL_LIMIT && size <= STORE_PAGE_DATA_SIZE)
+		{
+			bool written;
+			uint32_t lastPage = slot.lastPage;
+			uint32_t lastUsed = slot.lastUsed;
+
+			if (slot.lastUsed + size <= STORE_PAGE_DATA_SIZE)
+			{
+				// Into the Last Page (Data first, then the used count that makes it visible)
+				SaveWriter used;
+				used.u16(static_cast<uint16_t>(slot.lastUsed + size));
+
+				written = store.writeAt(store.pageOffset(slot.lastPage) + STORE_PAGE_HEADER_SIZE + slot.lastUsed, frame.bytes.data(), size) &&
+					store.writeAt(store.pageOffset(slot.lastPage) + 4, used.bytes.data(), 2);
+
+				lastUsed += size;
+			}
+			else
+			{
+				// Onto a New Page (Linking it in makes it visible)
+				StoreSlot tail;
+				SaveWriter next;
+
+				written = storeWriteRecord(store, frame.bytes, tail);
+				next.u32(tail.firstPage);
+				written = written && store.writeAt(store.pageOffset(slot.lastPage), next.bytes.data(), 4);
+
+				lastPage = tail.lastPage;
+				lastUsed = tail.lastUsed;
+			}
+
+			// Only a Complete Append Moves the Tail
+			if (written)
+			{
+				slot.lastPage = lastPage;
+				slot.lastUsed = lastUsed;
+				slot.saved = player;
+				slot.journalBytes += size;
+
+				saveStats.journalAppends++;
+				saveStats.lastSaveBytes = size;
+				return true;
+			}
+
+			// Fall Through to a Compaction
+		}
+	}
+
+	// Compaction (New Chain, then the Bucket Switch that Commits it, then Free the Old Chain)
+	StoreSlot fresh;
+	string bytes = encodeSave(player);
+
+	if (!storeWriteRecord(store, bytes, fresh))
+	{
+		return false;
+	}
+
+	StoreEntry entry;
+	bool exists = storeProbe(store, player.name, entry);
+
+	if (!exists && static_cast<uint64_t>(store.trainerCount + 1) * 10 > static_cast<uint64_t>(store.bucketCount) * 7)
+	{
+		if (!storeGrowIndex(store))
+		{
+			return false;
+		}
+
+		storeProbe(store, player.name, entry);
+	}
+
+	string bucket = storeEncodeBucket(trainerNameHash(player.name), fresh.firstPage, player.name);
+	if (!store.writeAt(store.bucketOffset(entry.bucket), bucket.data(), bucket.size()))
+	{
+		return false;
+	}
+
+	if (exists)
+	{
+		vector<uint32_t> oldPages;
+		StoreSlot old;
+		string oldBytes;
+
+		storeReadRecord(store, entry.firstPage, oldBytes, old, &oldPages);
+		storeFreePages(store, oldPages);
+	}
+	else
+	{
+		store.trainerCount++;
+	}
+
+	storeWriteHeader(store);
+
+	fresh.saved = player;
+	fresh.known = true;
+	slot = fresh;
+
+	saveStats.compactions++;
+	saveStats.lastSaveBytes = bytes.size();
+
+	return true;
+}
+// *******************************************
+//           journalDelta
+//    Appends the records that turn saved into
+//    player. Returns false if the difference
+//    can't be journaled (new trainer, fewer
+//    Pokemon or a Pokemon was replaced).
+//********************************************
+bool journalDelta(const PlayerData &saved, const PlayerData &player, SaveWriter &out)
+{
+	// Only the Party and the Bag are Journaled
+	if (player.name != saved.name || player.rivalName != saved.rivalName || player.pokemonOwned < saved.pokemonOwned)
+	{
+		return false;
+	}
+
+	auto record = [&out](JournalRecordType type, int slot, int oldValue, int newValue)
+	{
+		if (oldValue != newValue)
+		{
+			out.u8(static_cast<uint8_t>(type));
+			out.u8(static_cast<uint8_t>(slot));
+			out.i32(newValue);
+		}
+	};
+
+	// Trainer
+	record(JOURNAL_MONEY, 0, saved.money, player.money);
+
+	for (int i = 0; i < ITEMS_IN_GAME; i++)
+	{
+		record(JOURNAL_ITEM, i, saved.itemsOwned[i], player.itemsOwned[i]);
+	}
+
+	// Party
+	for (int i = 0; i < player.pokemonOwned; i++)
+	{
+		const PokemonData &pokemon = player.pokemon[i];
+		PokemonData before;
+
+		if (i < saved.pokemonOwned)
+		{
+			before = saved.pokemon[i];
+
+			if (before.nickname != pokemon.nickname || before.species != pokemon.species)
+			{
+				return false;
+			}
+		}
+		else
+		{
+			// Newly Caught (Fields start from a fresh PokemonData)
+			if (pokemon.name().size() > 255)
+			{
+				return false;
+			}
+
+			out.u8(JOURNAL_CAUGHT);
+			out.u8(static_cast<uint8_t>(i));
+			out.u8(static_cast<uint8_t>(pokemon.species));
+			out.u8(static_cast<uint8_t>(pokemon.name().size()));
+			out.bytes += pokemon.name();
+		}
+
+		record(JOURNAL_HEALTH, i, before.health, pokemon.health);
+		record(JOURNAL_LEVEL, i, before.level, pokemon.level);
+		record(JOURNAL_EXP, i, before.exp, pokemon.exp);
+		record(JOURNAL_MAX_HEALTH, i, before.maxHealth, pokemon.maxHealth);
+		record(JOURNAL_DEAD, i, before.isDead, pokemon.isDead);
+	}
+
+	return true;
+}
+// *******************************************
+//           replayJournalFrames
+//    Applies the journal frames that start at
+//    at on top of player. Returns where the
+//    last good frame ends.
+//********************************************
+size_t replayJournalFrames(const string &bytes, size_t at, PlayerData &player)
+{
+	SaveReader in(bytes);
+
+	while (at + 8 <= bytes.size())
+	{
+		uint32_t length = in.u32(at);
+
+		if (length > bytes.size() - at - 8 || crc32c(bytes.data() + at, length + 4) != in.u32(at + 4 + length))
+		{
+			break;
+		}
+
+		PlayerData replayed = player;
+		if (!applyJournalFrame(in, at + 4, at + 4 + length, replayed))
+		{
+			break;
+		}
+
+		player = replayed;
+		at += length + 8;
+	}
+
+	return at;
+}
+// *******************************************
+//           applyJournalFrame
+//    Applies the records between at and end.
+//    Returns false on a malformed record.
+//********************************************
+bool applyJournalFrame(const SaveReader &in, size_t at, size_t end, PlayerData &player)
+{
+	while (at < end)
+	{
+		if (end - at < 2)
+		{
+			return false;
+		}
+
+		JournalRecordType type = static_cast<JournalRecordType>(in.u8(at));
+		int slot = in.u8(at + 1);
+
+		// Newly Caught Pokemon
+		if (type == JOURNAL_CAUGHT)
+		{
+			if (end - at < 4 || slot != player.pokemonOwned || in.u8(at + 2) >= POKEMON_IN_GAME || end - at - 4 < in.u8(at + 3))
+			{
+				return false;
+			}
+
+			PokemonData caught;
+			caught.species = static_cast<PokemonSpecies>(in.u8(at + 2));
+			if (caught.rename(string_view(reinterpret_cast<const char *>(in.data) + at + 4, in.u8(at + 3))) == FAILED ||
+				player.addPokemon(caught) == FAILED)
+			{
+				return false;
+			}
+
+			at += 4 + in.u8(at + 3);
+			continue;
+		}
+
+		// Value Records
+		if (end - at < 6)
+		{
+			return false;
+		}
+
+		int value = in.i32(at + 2);
+		at += 6;
+
+		if (type == JOURNAL_MONEY)
+		{
+			player.money = value;
+			continue;
+		}
+
+		if (type == JOURNAL_ITEM)
+		{
+			if (slot >= ITEMS_IN_GAME)
+			{
+				return false;
+			}
+
+			player.itemsOwned[slot] = value;
+			continue;
+		}
+
+		if (slot >= player.pokemonOwned)
+		{
+			return false;
+		}
+
+		PokemonData &pokemon = player.pokemon[slot];
+
+		// Stats have to fit the Pokemon Record
+		if (type != JOURNAL_EXP && type != JOURNAL_DEAD && (value < 0 || value > ((type == JOURNAL_LEVEL) ? POKEMON_MAX_LEVEL : POKEMON_MAX_HEALTH)))
+		{
+			return false;
+		}
+
+		switch (type)
+		{
+		case JOURNAL_HEALTH:
+			pokemon.health = value;
+			break;
+		case JOURNAL_LEVEL:
+			pokemon.level = value;
+			break;
+		case JOURNAL_EXP:
+			pokemon.exp = value;
+			break;
+		case JOURNAL_MAX_HEALTH:
+			pokemon.maxHealth = value;
+			break;
+		case JOURNAL_DEAD:
+			pokemon.isDead = value != 0;
+			break;
+		default:
+			return false;
+		}
+	}
+
+	return true;
+}
+// *******************************************
+//           encodeSave
+//    Builds the save.dat bytes for a Player
+//********************************************
+string encodeSave(const PlayerData &player)
+{
+	SaveWriter out;
+
+	// Size Everything Up Front
+	uint32_t stringsLength = static_cast<uint32_t>(player.name.size() + player.rivalName.size());
+	for (int i = 0; i < player.pokemonOwned; i++)
+	{
+		stringsLength += static_cast<uint32_t>(player.pokemon[i].name().size());
+	}
+
+	uint32_t payloadLength = SAVE_TRAINER_RECORD_SIZE + 4 * ITEMS_IN_GAME + SAVE_POKEMON_RECORD_SIZE * player.pokemonOwned + stringsLength;
+	out.bytes.reserve(SAVE_HEADER_SIZE + payloadLength);
+
+	// Header (The Checksum is filled in last)
+	out.bytes.append(SAVE_MAGIC, 4);
+	out.u16(SAVE_VERSION);
+	out.u16(1);
+	out.u32(SAVE_HEADER_SIZE);
+	out.u32(payloadLength);
+	out.u32(0);
+	out.u16(SAVE_TRAINER_RECORD_SIZE);
+	out.u16(SAVE_POKEMON_RECORD_SIZE);
+	out.u16(ITEMS_IN_GAME);
+	out.u16(static_cast<uint16_t>(player.pokemonOwned));
+	out.u32(stringsLength);
+
+	// Trainer Record
+	uint32_t stringAt = 0;
+
+	out.u32(stringAt);
+	out.u32(static_cast<uint32_t>(player.name.size()));
+	stringAt += static_cast<uint32_t>(player.name.size());
+
+	out.u32(stringAt);
+	out.u32(static_cast<uint32_t>(player.rivalName.size()));
+	stringAt += static_cast<uint32_t>(player.rivalName.size());
+
+	out.i32(player.money);
+	out.i32(player.pokemonOwned);
+
+	// Item Quantities
+	for (int i = 0; i < ITEMS_IN_GAME; i++)
+	{
+		out.i32(player.itemsOwned[i]);
+	}
+
+	// Pokemon Records
+	for (int i = 0; i < player.pokemonOwned; i++)
+	{
+		const PokemonData &pokemon = player.pokemon[i];
+
+		out.u32(stringAt);
+		out.u32(static_cast<uint32_t>(pokemon.name().size()));
+		stringAt += static_cast<uint32_t>(pokemon.name().size());
+
+		out.i32(pokemon.health);
+		out.i32(pokemon.level);
+		out.i32(pokemon.exp);
+		out.i32(pokemon.maxHealth);
+		out.u8(static_cast<uint8_t>(pokemon.species));
+		out.u8(pokemon.isDead ? 1 : 0);
+		out.u16(0);
+	}
+
+	// Strings
+	out.bytes += player.name;
+	out.bytes += player.rivalName;
+	for (int i = 0; i < player.pokemonOwned; i++)
+	{
+		out.bytes += player.pokemon[i].name();
+	}
+
+	// Checksum (Everything but the checksum field itself)
+	uint32_t checksum = crc32c(out.bytes.data(), 16);
+	checksum = crc32c(out.bytes.data() + 20, out.bytes.size() - 20, checksum);
+	out.patch32(16, checksum);
+
+	return out.bytes;
+}
+// *******************************************
+//           decodeSave
+//    Reads save.dat bytes into a Player.
+//    The Player is only changed if the whole
+//    file checks out.
+//********************************************
+bool decodeSave(const string &bytes, PlayerData &player, string &error)
+{
+	SaveReader in(bytes);
+
+	// Header
+	if (bytes.size() < SAVE_HEADER_SIZE || bytes.compare(0, 4, SAVE_MAGIC, 4) != 0)
+	{
+		error = "not a save file";
+		return false;
+	}
+
+	SaveHeader header;
+	header.version = in.u16(4);
+	header.compatVersion = in.u16(6);
+	header.headerSize = in.u32(8);
+	header.payloadLength = in.u32(12);
+	header.checksum = in.u32(16);
+	header.trainerRecordSize = in.u16(20);
+	header.pokemonRecordSize = in.u16(22);
+	header.itemCount = in.u16(24);
+	header.pokemonCount = in.u16(26);
+	header.stringsLength = in.u32(28);
+
+	if (header.compatVersion > SAVE_VERSION)
+	{
+		error = "saved by a newer version (" + to_string(header.version) + ")";
+		return false;
+	}
+
+	if (header.headerSize < SAVE_HEADER_SIZE || header.headerSize > bytes.size() || header.payloadLength != bytes.size() - header.headerSize)
+	{
+		error = "file is truncated";
+		return false;
+	}
+
+	uint32_t checksum = crc32c(bytes.data(), 16);
+	checksum = crc32c(bytes.data() + 20, bytes.size() - 20, checksum);
+
+	if (checksum != header.checksum)
+	{
+		error = "checksum mismatch";
+		return false;
+	}
+
+	// Section Layout
+	if (header.trainerRecordSize < SAVE_TRAINER_RECORD_SIZE || header.pokemonRecordSize < SAVE_POKEMON_RECORD_SIZE || header.pokemonCount > PLAYER_MAX_POKEMON)
+	{
+		error = "bad record sizes";
+		return false;
+	}
+
+	size_t trainerAt = header.headerSize;
+	size_t itemsAt = trainerAt + header.trainerRecordSize;
+	size_t pokemonAt = itemsAt + 4 * static_cast<size_t>(header.itemCount);
+	size_t stringsAt = pokemonAt + static_cast<size_t>(header.pokemonRecordSize) * header.pokemonCount;
+
+	if (stringsAt + header.stringsLength > bytes.size())
+	{
+		error = "sections overrun the file";
+		return false;
+	}
+
+	// Trainer Record
+	PlayerData loaded;
+
+	if (!in.text(stringsAt, header.stringsLength, in.u32(trainerAt), in.u32(trainerAt + 4), loaded.name) ||
+		!in.text(stringsAt, header.stringsLength, in.u32(trainerAt + 8), in.u32(trainerAt + 12), loaded.rivalName))
+	{
+		error = "bad trainer name";
+		return false;
+	}
+
+	loaded.money = in.i32(trainerAt + 16);
+	loaded.pokemonOwned = header.pokemonCount;
+
+	// Item Quantities (Items this version doesn't know are skipped)
+	for (int i = 0; i < ITEMS_IN_GAME && i < header.itemCount; i++)
+	{
+		loaded.itemsOwned[i] = in.i32(itemsAt + 4 * i);
+	}
+
+	// Pokemon Records
+	for (int i = 0; i < header.pokemonCount; i++)
+	{
+		size_t at = pokemonAt + static_cast<size_t>(header.pokemonRecordSize) * i;
+		PokemonData &pokemon = loaded.pokemon[i];
+		string_view name;
+
+		if (!in.text(stringsAt, header.stringsLength, in.u32(at), in.u32(at + 4), name))
+		{
+			error = "bad pokemon name";
+			return false;
+		}
+
+		int32_t health = in.i32(at + 8);
+		int32_t level = in.i32(at + 12);
+		int32_t maxHealth = in.i32(at + 20);
+
+		if (health < 0 || health > POKEMON_MAX_HEALTH || level < 1 || level > POKEMON_MAX_LEVEL || maxHealth < 0 || maxHealth > POKEMON_MAX_HEALTH)
+		{
+			error = "pokemon stats out of range";
+			return false;
+		}
+
+		pokemon.health = health;
+		pokemon.level = level;
+		pokemon.exp = in.i32(at + 16);
+		pokemon.maxHealth = maxHealth;
+		pokemon.isDead = in.u8(at + 25) != 0;
+
+		if (in.u8(at + 24) >= POKEMON_IN_GAME)
+		{
+			error = "unknown species";
+			return false;
+		}
+
+		// The Name is kept only if it isn't the Species Name
+		pokemon.species = static_cast<PokemonSpecies>(in.u8(at + 24));
+		if (pokemon.rename(name) == FAILED)
+		{
+			error = "too many pokemon nicknames";
+			return false;
+		}
+	}
+
+	player = loaded;
+	return true;
+}
+// *******************************************
+//           readWholeFile
+//    Reads a file into bytes with one read
+//********************************************
+bool readWholeFile(const char *path, string &bytes)
+{
+	ifstream file(path, ios::in | ios::binary | ios::ate);
+
+	if (!file)
+	{
+		return false;
+	}
+
+	streamoff size = file.tellg();
+	if (size < 0)
+	{
+		return false;
+	}
+
+	bytes.resize(static_cast<size_t>(size));
+	file.seekg(0);
+	file.read(&bytes[0], size);
+
+	return static_cast<bool>(file);
+}
+// *******************************************
+//           crc32c
+//    CRC-32C (Castagnoli) of a block. Pass
+//    the previous result as crc to continue
+//    over another block. Uses the SSE4.2
+//    crc32 instruction when the CPU has it.
+//********************************************
+#if defined(BATTLE_SIMD) && (defined(__x86_64__) || defined(_M_X64))
+BATTLE_TARGET("sse4.2")
+uint32_t crc32cSSE42(const unsigned char *data, size_t length, uint32_t crc)
+{
+	uint64_t wide = crc;
+
+	for (; length >= 8; data += 8, length -= 8)
+	{
+		uint64_t block;
+		memcpy(&block, data, 8);
+		wide = _mm_crc32_u64(wide, block);
+	}
+
+	crc = static_cast<uint32_t>(wide);
+
+	for (; length > 0; data++, length--)
+	{
+		crc = _mm_crc32_u8(crc, *data);
+	}
+
+	return crc;
+}
+#define HAVE_CRC32C_INSTRUCTION 1
+#endif
+
+uint32_t crc32c(const void *data, size_t length, uint32_t crc)
+{
+	const unsigned char *bytes = static_cast<const unsigned char *>(data);
+	crc = ~crc;
+
+#ifdef HAVE_CRC32C_INSTRUCTION
+	static const bool hardware = cpuSupports("sse4.2");
+
+	if (hardware)
+	{
+		return ~crc32cSSE42(bytes, length, crc);
+	}
+#endif
+
+	for (size_t i = 0; i < length; i++)
+	{
+		crc = CRC32C_TABLE.entry[(crc ^ bytes[i]) & 0xFF] ^ (crc >> 8);
+	}
+
+	return ~crc;
+}
+// *******************************************
+//           parseLegacySave
+//    Reads the old line by line save.txt
+//    format straight out of text. Names are
+//    views into text and numbers go through
+//    from_chars, so only names that outgrow
+//    player's strings allocate. On false,
+//    error says where and why, and player is
+//    left half written.
+//********************************************
+bool parseLegacySave(string_view text, PlayerData &player, LegacyParseError &error)
+{
+	// Constant Values
+	const int HIGHEST = 1000000000;
+
+	LegacyReader reader(text);
+	string_view name;
+
+	error = LegacyParseError();
+
+	// One Number on its own Line
+	auto numberLine = [&](int low, int high, const char *what, int &value)
+	{
+		return reader.number(low, high, what, value, error) && reader.endLine(error, what);
+	};
+
+	// Trainer
+	if (!reader.name(name, error))
+	{
+		return false;
+	}
+	player.name.assign(name.data(), name.size());
+
+	if (!reader.name(name, error))
+	{
+		return false;
+	}
+	player.rivalName.assign(name.data(), name.size());
+
+	if (!numberLine(0, HIGHEST, "bad money", player.money) || !numberLine(0, PLAYER_MAX_POKEMON, "bad pokemon owned", player.pokemonOwned))
+	{
+		return false;
+	}
+
+	// Item Quantities (One line, separated by spaces)
+	for (int i = 0; i < ITEMS_IN_GAME; i++)
+	{
+		reader.skipSpaces();
+
+		if (!reader.number(0, HIGHEST, "bad item quantity", player.itemsOwned[i], error))
+		{
+			return false;
+		}
+	}
+
+	reader.skipSpaces();
+	if (!reader.endLine(error, "more item quantities than items"))
+	{
+		return false;
+	}
+
+	// Pokemon (7 lines each)
+	for (int i = 0; i < player.pokemonOwned; i++)
+	{
+		PokemonData &pokemon = player.pokemon[i];
+		int health = 0;
+		int level = 0;
+		int exp = 0;
+		int species = 0;
+		int isDead = 0;
+		int maxHealth = 0;
+
+		if (!reader.name(name, error))
+		{
+			return false;
+		}
+
+		if (!numberLine(0, POKEMON_MAX_HEALTH, "bad pokemon health", health) ||
+			!numberLine(1, POKEMON_MAX_LEVEL, "bad pokemon level", level) ||
+			!numberLine(0, HIGHEST, "bad pokemon exp", exp) ||
+			!numberLine(0, POKEMON_IN_GAME - 1, "bad pokemon species", species) ||
+			!numberLine(0, 1, "bad pokemon dead flag", isDead) ||
+			!numberLine(1, POKEMON_MAX_HEALTH, "bad pokemon max health", maxHealth))
+		{
+			return false;
+		}
+
+		if (health > maxHealth)
+		{
+			return reader.fail(error, "pokemon health above max health");
+		}
+
+		pokemon.health = health;
+		pokemon.level = level;
+		pokemon.exp = exp;
+		pokemon.species = static_cast<PokemonSpecies>(species);
+		pokemon.isDead = isDead != 0;
+		pokemon.maxHealth = maxHealth;
+		if (pokemon.rename(name) == FAILED)
+		{
+			return reader.fail(error, "too many pokemon nicknames");
+		}
+	}
+
+	// Only Blank Lines may Follow
+	while (reader.at < text.size())
+	{
+		if (!reader.endLine(error, "unexpected data after the last pokemon"))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+// *******************************************
+//           loadLegacyGame
+//    Reads save.txt (The old line by line
+//    text format) into player
+//********************************************
+bool loadLegacyGame(const char *path, PlayerData &player, LegacyParseError &error)
+{
+	string bytes;
+
+	if (!readWholeFile(path, bytes))
+	{
+		error.message = "could not read file";
+		return false;
+	}
+
+	return parseLegacySave(bytes, player, error);
+}
+// *******************************************
+//           ingestSavesMode
+//    Command line entry point for:
+//    ingest-saves DIR [--dry-run]
+//                 [--threads T]
+//    Imports every legacy save.txt under DIR
+//    into the Trainer Store, parsing on every
+//    core. --dry-run only parses them (to
+//    check or time them).
+//********************************************
+int ingestSavesMode(int argc, char *argv[])
+{
+	if (argc < 3)
+	{
+		cout << "Usage: ingest-saves DIR [--dry-run] [--threads T]" << endl;
+		return 1;
+	}
+
+	bool dryRun = false;
+	int threads = 0;
+	for (int i = 3; i < argc; i++)
+	{
+		string option = argv[i];
+
+		if (option == "--dry-run")
+		{
+			dryRun = true;
+		}
+		else if (option == "--threads" && i + 1 < argc)
+		{
+			threads = stoi(argv[++i]);
+		}
+	}
+
+	string error;
+	if (!dryRun && !storeOpen(trainerStore, storePath, error))
+	{
+		cout << "Could not open " << storePath << ": " << error << endl;
+		return 1;
+	}
+
+	auto start = chrono::steady_clock::now();
+
+	// Find Every File First (The workers split them up)
+	vector<string> paths;
+	error_code walkError;
+	for (filesystem::recursive_directory_iterator item(argv[2], walkError), end; !walkError && item != end; item.increment(walkError))
+	{
+		if (item->is_regular_file())
+		{
+			paths.push_back(item->path().string());
+		}
+	}
+
+	if (walkError)
+	{
+		cout << argv[2] << ": " << walkError.message() << endl;
+		return 1;
+	}
+
+	// Parse (and Import) on every Core
+	WorkStealingPool pool(threads);
+	vector<IngestWorker> workers(pool.threadCount);
+	mutex reportLock;
+
+	pool.run(static_cast<int>(paths.size()), [&](int id, int task)
+	{
+		IngestWorker &worker = workers[id];
+		const string &path = paths[task];
+
+		if (!readWholeFile(path.c_str(), worker.bytes))
+		{
+			lock_guard<mutex> guard(reportLock);
+			cout << path << ": could not read file" << endl;
+			worker.failed++;
+			return;
+		}
+
+		auto parseStart = chrono::steady_clock::now();
+		bool parsed = parseLegacySave(worker.bytes, worker.player, worker.error);
+		worker.parseTime += chrono::steady_clock::now() - parseStart;
+		worker.bytesParsed += worker.bytes.size();
+
+		if (!parsed)
+		{
+			lock_guard<mutex> guard(reportLock);
+			cout << path << ":" << worker.error.line << ": " << worker.error.message << " (byte " << worker.error.offset << ")" << endl;
+			worker.failed++;
+			return;
+		}
+
+		// Into the Store (Trainers with the same name are replaced)
+		worker.slot = StoreSlot();
+		if (!dryRun && !storeSave(trainerStore, worker.player, worker.slot))
+		{
+			lock_guard<mutex> guard(reportLock);
+			cout << path << ": could not write to " << storePath << endl;
+			worker.failed++;
+			return;
+		}
+
+		worker.imported++;
+	});
+
+	// Report
+	long long imported = 0;
+	long long failed = 0;
+	size_t totalBytes = 0;
+	double parseSeconds = 0;
+
+	for (const IngestWorker &worker : workers)
+	{
+		imported += worker.imported;
+		failed += worker.failed;
+		totalBytes += worker.bytesParsed;
+		parseSeconds += chrono::duration<double>(worker.parseTime).count();
+	}
+
+	double totalSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	double megabytes = totalBytes / (1024.0 * 1024.0);
+
+	cout << "Files: " << paths.size() << ", " << (dryRun ? "parsed" : "imported") << ": " << imported << ", failed: " << failed
+		<< ", threads: " << pool.threadCount << endl;
+	cout << fixed << setprecision(2);
+	cout << "Parsed " << megabytes << " MB in " << parseSeconds * 1000.0 << " ms of parser time ("
+		<< ((parseSeconds > 0) ? megabytes / parseSeconds : 0.0) << " MB/s per thread)" << endl;
+	cout << "Wall time " << totalSeconds * 1000.0 << " ms (" << ((totalSeconds > 0) ? megabytes / totalSeconds : 0.0) << " MB/s)" << endl;
+
+	return (failed == 0) ? 0 : 1;
+}
+// *******************************************
+//           replayMode
+//    Plays a recorded script through the
+//    whole game as fast as it goes, with the
+//    frames built but never shown:
+//    replay SCRIPT [--repeat N]
+//    Scripts come from --record FILE. Saves
+//    go to the store (use --store PATH to
+//    keep them apart).
+//********************************************
+int replayMode(int argc, char *argv[])
+{
+	if (argc < 3)
+	{
+		cout << "Usage: replay SCRIPT [--repeat N] [--store PATH]" << endl;
+		return 1;
+	}
+
+	int repeat = 1;
+	for (int i = 3; i + 1 < argc; i++)
+	{
+		if (string(argv[i]) == "--repeat")
+		{
+			repeat = max(1, stoi(argv[++i]));
+		}
+	}
+
+	// Whole Script into Memory first
+	ScriptInput file;
+	if (!file.open(argv[2]))
+	{
+		cout << "Could not read " << argv[2] << endl;
+		return 1;
+	}
+
+	vector<string> script;
+	string line;
+	while (file.nextLine(line))
+	{
+		script.push_back(line);
+	}
+
+	if (file.hasSeed)
+	{
+		gameSeed = file.seed;
+	}
+
+	// Headless Terminal
+	VectorInput input;
+	input.script = &script;
+
+	Terminal replayTerminal(&input);
+	replayTerminal.output.discard = true;
+	replayTerminal.battleScreen.console = false;
+
+	terminal = &replayTerminal;
+	screen.rdbuf(&replayTerminal.output);
+
+	auto start = chrono::steady_clock::now();
+	long long linesRead = 0;
+
+	for (int r = 0; r < repeat; r++)
+	{
+		// Every Run rolls the same Battles
+		input.rewind();
+		replayTerminal.input.clear();
+		battlesStarted = 0;
+
+		PlayerData player;
+
+		try
+		{
+			mainMenu(player);
+		}
+		catch (const InputClosed &)
+		{
+		}
+
+		replayTerminal.output.present();
+		linesRead += input.at;
+	}
+
+	double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+	terminal = &consoleTerminal;
+	screen.rdbuf(&consoleTerminal.output);
+
+	saveWorker.stop();
+
+	// Report
+	cout << fixed << setprecision(2);
+	cout << "Replayed " << argv[2] << " (" << script.size() << " lines, seed " << gameSeed << ") " << repeat << " times in " << seconds * 1000.0 << " ms" << endl;
+	cout << "Inputs: " << linesRead << " (" << ((linesRead > 0) ? seconds * 1e6 / linesRead : 0.0) << " us each), frames: "
+		<< replayTerminal.output.frames << ", bytes drawn: " << replayTerminal.output.bytesPresented << endl;
+
+	if (showOutputStats)
+	{
+		printMenuStatistics(consoleMenuStatistics);
+	}
+
+	// Response Times (Replays of the same script make a repeatable latency check for a build)
+	LatencyStatistics latency = replayTerminal.latency;
+	addSaveLatency(latency);
+	printLatencyStatistics(latency);
+
+	return checkLatencyObjectives(latency) ? 0 : 2;
+}
+// *******************************************
+//           serverMode
+//    Lets many players in at once over a
+//    local Unix socket (server [SOCKET]).
+//    Clients connect with
+//    socat - UNIX-CONNECT:pokemon.sock
+//    Every client gets its own session, all
+//    of them share one epoll loop.
+//********************************************
+#ifdef HAVE_EPOLL
+int serverMode(int argc, char *argv[])
+{
+	const char *path = (argc > 2 && argv[2][0] != '-') ? argv[2] : SERVER_SOCKET;
+
+	sockaddr_un address = {};
+	address.sun_family = AF_UNIX;
+	if (strlen(path) >= sizeof(address.sun_path))
+	{
+		cout << "Socket path too long: " << path << endl;
+		return 1;
+	}
+	strcpy(address.sun_path, path);
+
+	// Thousands of Players need Thousands of Descriptors
+	rlimit files;
+	if (getrlimit(RLIMIT_NOFILE, &files) == 0 && files.rlim_cur < files.rlim_max)
+	{
+		files.rlim_cur = files.rlim_max;
+		setrlimit(RLIMIT_NOFILE, &files);
+	}
+
+	// Listen (A socket left by an earlier run is replaced)
+	int listener = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	unlink(path);
+
+	if (listener < 0 || bind(listener, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 || listen(listener, SOMAXCONN) != 0)
+	{
+		cout << "Could not listen on " << path << ": " << strerror(errno) << endl;
+		return 1;
+	}
+
+	int poll = epoll_create1(EPOLL_CLOEXEC);
+	epoll_event watch = {};
+	watch.events = EPOLLIN;
+	watch.data.fd = listener;
+	epoll_ctl(poll, EPOLL_CTL_ADD, listener, &watch);
+
+	// Stop Cleanly on Ctrl+C, and let send() report Gone Clients instead of Killing Us
+	struct sigaction stopAction = {};
+	stopAction.sa_handler = [](int) { serverStopping = 1; };
+	sigaction(SIGINT, &stopAction, nullptr);
+	sigaction(SIGTERM, &stopAction, nullptr);
+	signal(SIGPIPE, SIG_IGN);
+
+	cout << "Listening on " << path << endl;
+
+	unordered_map<int, unique_ptr<Session>> sessions;
+	long long served = 0;
+	size_t mostAtOnce = 0;
+	epoll_event events[SERVER_EVENTS];
+
+	while (!serverStopping)
+	{
+		int count = epoll_wait(poll, events, SERVER_EVENTS, -1);
+
+		if (count < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+			break;
+		}
+
+		for (int e = 0; e < count; e++)
+		{
+			int fd = events[e].data.fd;
+
+			// New Players
+			if (fd == listener)
+			{
+				int client;
+				while ((client = accept4(listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0)
+				{
+					unique_ptr<Session> session(new Session(client));
+
+					watch.events = EPOLLIN;
+					watch.data.fd = client;
+					if (epoll_ctl(poll, EPOLL_CTL_ADD, client, &watch) != 0 || !sessionStart(*session))
+					{
+						continue;
+					}
+
+					served++;
+					if (sessionSend(*session, poll))
+					{
+						sessions[client] = move(session);
+						mostAtOnce = max(mostAtOnce, sessions.size());
+					}
+					else
+					{
+						sessionEnd(*session);
+					}
+				}
+				continue;
+			}
+
+			auto found = sessions.find(fd);
+			if (found == sessions.end())
+			{
+				continue;
+			}
+
+			Session &session = *found->second;
+			bool open = true;
+
+			if (events[e].events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+			{
+				open = sessionRead(session);
+			}
+
+			if (open)
+			{
+				open = sessionSend(session, poll);
+			}
+
+			// Done once the Player has left and has been sent everything
+			if (!open || (session.finished && session.outbox.empty()))
+			{
+				sessionEnd(session);
+				sessions.erase(found);
+			}
+		}
+	}
+
+	// Let Every Session Unwind, then Save
+	for (auto &entry : sessions)
+	{
+		sessionEnd(*entry.second);
+	}
+	sessions.clear();
+
+	saveWorker.stop();
+
+	close(poll);
+	close(listener);
+	unlink(path);
+
+	if (showOutputStats)
+	{
+		cout << "Sessions: " << served << " served, " << mostAtOnce << " at most at once" << endl;
+		cout << "Save requests: " << saveWorker.requested << ", coalesced: " << saveWorker.coalesced << endl;
+		cout << "Trainer cache: " << trainerCache.hits << " hits, " << trainerCache.misses << " misses, "
+			<< trainerCache.evictions << " evictions, " << trainerCache.writeBacks << " write backs, "
+			<< trainerCache.writeFailures << " failed writes" << endl;
+		printMenuStatistics(consoleMenuStatistics);
+	}
+
+	// Response Times of Every Session
+	addSaveLatency(serverLatency);
+
+	if (showOutputStats)
+	{
+		printLatencyStatistics(serverLatency);
+	}
+
+	return checkLatencyObjectives(serverLatency) ? 0 : 2;
+}
+// *******************************************
+//           sessionStart
+//    Gives a Session a stack (with a guard
+//    page under it) and runs it up to the
+//    first time it waits for input.
+//********************************************
+bool sessionStart(Session &session)
+{
+	size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+	session.stackBytes = SESSION_STACK_SIZE + page;
+
+	void *memory = mmap(nullptr, session.stackBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_STACK, -1, 0);
+	if (memory == MAP_FAILED)
+	{
+		return false;
+	}
+
+	session.stack = static_cast<char *>(memory);
+	mprotect(session.stack, page, PROT_NONE);
+
+	getcontext(&session.context);
+	session.context.uc_stack.ss_sp = session.stack + page;
+	session.context.uc_stack.ss_size = SESSION_STACK_SIZE;
+	session.context.uc_link = &serverContext;
+	makecontext(&session.context, sessionMain, 0);
+
+	// Only a Sample of Sessions is Traced (--trace-sample N)
+	session.terminal.traceTrack = tracer.sampleTrack("session");
+
+	session.started = true;
+	sessionResume(session);
+	return true;
+}
+// *******************************************
+//           sessionMain
+//    Where a Session's fiber starts. The
+//    ordinary Main Menu, with the session's
+//    Terminal as the screen and keyboard.
+//********************************************
+void sessionMain()
+{
+	Session &session = *runningSession;
+
+	try
+	{
+		mainMenu(session.trainer);
+	}
+	catch (const InputClosed &)
+	{
+		// Client is Gone, Nothing Left to Show
+	}
+
+	session.finished = true;
+}
+// *******************************************
+//           sessionResume
+//    Switches to a Session until it waits for
+//    input again or is finished.
+//********************************************
+void sessionResume(Session &session)
+{
+	runningSession = &session;
+	terminal = &session.terminal;
+	screen.rdbuf(&session.terminal.output);
+
+	swapcontext(&serverContext, &session.context);
+
+	// Whatever it Printed Last goes out with the Rest
+	session.terminal.output.present();
+
+	runningSession = nullptr;
+	terminal = &consoleTerminal;
+	screen.rdbuf(&consoleTerminal.output);
+}
+// *******************************************
+//           sessionWait
+//    Called by a Session that needs input.
+//    Queues what it printed and switches back
+//    to the server loop.
+//********************************************
+void sessionWait(Session &session)
+{
+	session.terminal.output.present();
+	swapcontext(&session.context, &serverContext);
+}
+// *******************************************
+//           sessionRead
+//    Takes what a client sent (one read per
+//    event, so nobody can flood the loop) and
+//    lets the Session run with it. Returns
+//    false once the client is gone.
+//********************************************
+bool sessionRead(Session &session)
+{
+	char chunk[SESSION_READ_SIZE];
+	ssize_t got = read(session.fd, chunk, sizeof(chunk));
+
+	if (got < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR))
+	{
+		return true;
+	}
+
+	if (got <= 0)
+	{
+		return false;
+	}
+
+	if (session.finished)
+	{
+		return true;
+	}
+
+	// Terminals that send Carriage Returns would put them in Trainer names
+	for (ssize_t i = 0; i < got; i++)
+	{
+		if (chunk[i] != '\r')
+		{
+			session.in.received.push_back(chunk[i]);
+		}
+	}
+
+	if (!session.in.received.empty())
+	{
+		sessionResume(session);
+	}
+
+	return true;
+}
+// *******************************************
+//           sessionSend
+//    Sends as much of a Session's outbox as
+//    the socket takes, and watches for room
+//    when it takes less. Returns false if the
+//    client is gone or stopped reading.
+//********************************************
+bool sessionSend(Session &session, int poll)
+{
+	while (session.outboxSent < session.outbox.size())
+	{
+		ssize_t sent = send(session.fd, session.outbox.data() + session.outboxSent, session.outbox.size() - session.outboxSent, MSG_NOSIGNAL);
+
+		if (sent >= 0)
+		{
+			session.outboxSent += sent;
+			continue;
+		}
+
+		if (errno == EINTR)
+		{
+			continue;
+		}
+
+		if (errno != EAGAIN && errno != EWOULDBLOCK)
+		{
+			return false;
+		}
+
+		// Socket is Full (A client that never reads is let go)
+		if (session.outbox.size() - session.outboxSent > SESSION_OUTBOX_LIMIT)
+		{
+			return false;
+		}
+
+		if (!session.watchingWrites)
+		{
+			epoll_event watch = {};
+			watch.events = EPOLLIN | EPOLLOUT;
+			watch.data.fd = session.fd;
+			epoll_ctl(poll, EPOLL_CTL_MOD, session.fd, &watch);
+			session.watchingWrites = true;
+		}
+
+		return true;
+	}
+
+	// All Sent (The outbox keeps its capacity)
+	session.outbox.clear();
+	session.outboxSent = 0;
+
+	if (session.watchingWrites)
+	{
+		epoll_event watch = {};
+		watch.events = EPOLLIN;
+		watch.data.fd = session.fd;
+		epoll_ctl(poll, EPOLL_CTL_MOD, session.fd, &watch);
+		session.watchingWrites = false;
+	}
+
+	return true;
+}
+// *******************************************
+//           sessionEnd
+//    Unwinds a Session that is still running
+//    (its next read throws InputClosed) so
+//    its stack can be freed.
+//********************************************
+void sessionEnd(Session &session)
+{
+	if (session.started && !session.finished)
+	{
+		session.in.closed = true;
+		sessionResume(session);
+	}
+
+	// Keep its Response Times for the Server's Report
+	serverLatency.merge(session.terminal.latency);
+}
+#else
+int serverMode(int argc, char *argv[])
+{
+	cout << "server needs Linux (epoll)" << endl;
+	return 1;
+}
+#endif
+// *******************************************
+//           drawHealthUI
+//    Draws Health as | and *'s
+//********************************************
+void drawHealthUI(int hp, int max, ostream &out)
+{
+	// Draw Current HP Bars
+	HEALTH_RUN.write(out, hp);
+
+	// Draw HP Lost Stars
+	LOST_HEALTH_RUN.write(out, max - hp);
+}
+// *******************************************
+//           drawBattleUIHeader
+//    Draws Top Portion of Battle UI System
+//    This displays the name and health of the
+//    opponent.
+//********************************************
+void drawBattleUIHeader(PokemonData &attackingPokemon, ostream &out)
+{
+	// Draw First Line (60 Characters)
+	drawLines(60, out);
+
+	// Draw Attacking Pokemon Information
+	out << "= Target Name: " << attackingPokemon.name() << endl;
+	out << "= Target Level: " << attackingPokemon.level << endl;
+
+	out << "= Target HP: ";
+	drawHealthUI(attackingPokemon.health, attackingPokemon.maxHealth, out);
+	out << " (" << attackingPokemon.health << " HP / " << attackingPokemon.maxHealth << " HP) " << endl;
+
+	// Draw Last Line (60 Characters)
+	drawLines(60, out);
+}
+// *******************************************
+//           drawBattleUIFooter
+//    Draws Bottom Portion of Battle UI System
+//    Several Menu Systems are handled here.
+//    Allows the user to select to attack, bag
+//    swap out their pokemon, and attempt to
+//    flee
+//********************************************
+void drawBattleUIFooter(MenuLocation location, PlayerData &trainer, ostream &out)
+{
+	// Draw First Line (60 Characters)
+	drawLines(60, out);
+
+	if (location == ATTACK)
+	{
+		// Menu Lines are Built in the Terminal's Battle Arena
+		ArenaFrame frame(terminal->arena);
+		pmr::memory_resource *memory = terminal->arena.memory();
+
+		// Get Species Information of currently active trainer Pokemon (Read in place, not copied)
+		const PokemonData &trainersPokemon = trainer.pokemon[0];
+		PokemonSpecies trainerPokemonSpecies = trainersPokemon.species;
+		const PokemonSpeciesData &pokemonSpecies = speciesData[trainerPokemonSpecies];
+
+		// Assemble Menu Items
+		pmr::string attack1("1. ", memory);
+		attack1.append(pokemonSpecies.moveSet[0]);
+
+		pmr::string attack2("2. ", memory);
+		attack2.append(pokemonSpecies.moveSet[1]);
+
+		string_view back = "3. Previous Menu";
+
+		// Assemble Right Hand Side Stats about currently active trainer Pokemon
+		pmr::string trainerPokemonName("= Name:  ", memory);
+		trainerPokemonName.append(trainersPokemon.name());
+
+		pmr::string trainerPokemonLevel("= Level: ", memory);
+		trainerPokemonLevel.append(arenaNumber(trainersPokemon.level, memory));
+
+		pmr::string trainerPokemonHP("= HP:    ", memory);
+		trainerPokemonHP.append(arenaNumber(trainersPokemon.health, memory));
+		trainerPokemonHP.append(" HP / ");
+		trainerPokemonHP.append(arenaNumber(trainersPokemon.maxHealth, memory));
+		trainerPokemonHP.append(" HP");
+
+		// Output Information to Screen
+		out << left;
+		out << setw(20) << "Select Attack: " << setw(20) << "= Player Pokemon Stats:" << endl;
+		out << setw(20) << attack1 << setw(20) << "=" << endl;
+		out << setw(20) << attack2 << setw(20) << trainerPokemonName << endl;
+		out << right << setfill(' ') << setw(30) << trainerPokemonLevel << endl;
+		out << left << setw(20) << back << setw(20) << trainerPokemonHP << endl;
+	}
+	else if (location == BAG)
+	{
+		// Print Trainer's Name
+		out << trainer.name << "'s Bag:" << endl << endl;
+
+		// If the user has a ELIXIR in their inventory, show this as a selectable option.
+		if (trainer.itemsOwned[ELIXIR] > 0)
+		{
+			out << "1. Elixir   (Quantity: " << trainer.itemsOwned[ELIXIR] << ") " << endl;
+		}
+
+		// If the user has a POKEBALL in their inventory, show this as a selectable option.
+		if (trainer.itemsOwned[POKEBALL] > 0)
+		{
+			out << "2. Pokeball (Quantity: " << trainer.itemsOwned[POKEBALL] << ") " << endl;
+		}
+
+		// Print End of Menu
+		out << endl;
+		out << "3. Previous Menu" << endl;
+	}
+	else if (location == SELECTION)
+	{
+		// Print Trainer's Name
+		out << trainer.name << "'s Pokemon: " << endl;
+		out << endl;
+
+		// Display All Pokemon in Trainer's Inventory
+		for (int i = 0; i < trainer.pokemonOwned; i++)
+		{
+			out << i + 1 << ". " << left << setfill(' ') << setw(15) << trainer.pokemon[i].name();
+			out << " LV: " << trainer.pokemon[i].level;
+			out << " HP: " << trainer.pokemon[i].health;
+			out << " HP / " << trainer.pokemon[i].maxHealth << " HP" << endl;
+		}
+
+		// Finish End of Menu
+		out << endl;
+		out << "7. Previous Menu" << endl;
+	}
+	else
+	{
+		// Display Main Menu Screen
+		out << "=== 1. Attack == == 2. Bag == == 3. Pokemon == == 4. Flee ==" << endl;
 	}
 
 	// Draw End Line
+	drawLines(60, out);
+}
+// *******************************************
+//           drawBattleUI
+//    Draws the entire Battle UI and asks for
+//    a selection (the battle waits for it)
+//********************************************
+void drawBattleUI(PlayerData &trainer, PokemonData &attackingPokemon, MenuLocation location)
+{
+	PROFILE_SCOPE(PROFILE_DRAW_BATTLE_UI);
+	TraceSpan span("drawBattleUI");
+
+	// Draw Battle Header
+	drawBattleUIHeader(attackingPokemon, terminal->battleScreen.canvas);
+
+	// Display Opponent Pokemon
+	getPokemonIcon(attackingPokemon.species, terminal->battleScreen.canvas);
+
+	// Draw Battle Footer
+	drawBattleUIFooter(location, trainer, terminal->battleScreen.canvas);
+
+	// Send only what Changed since the Last Frame
+	terminal->battleScreen.present(screen);
+	terminal->output.battleFrame = true;
+
+	// Ask for a Selection
+	promptSelection();
+}
+// *******************************************
+//           clear
+//    Cross-Platform Console Clearing (ANSI
+//    escape codes, no shell is started)
+//********************************************
+void clear()
+{
+	// Clear and Move the Cursor Home
+	screen << "\x1b[2J\x1b[H";
+
+	// The Battle Screen has to be Repainted in Full next time
+	terminal->battleScreen.invalidate();
+}
+// *******************************************
+//           pressEntertoContinue
+//    Pause until User Presses Enter
+//********************************************
+void pressEnterToContinue()
+{
+	// Tell User
+	promptEnter();
+
+	// Wait for it
+	waitForEnter();
+}
+// *******************************************
+//           promptEnter
+//    Tells the User to Press Enter
+//********************************************
+void promptEnter()
+{
+	// New Line
+	screen << endl;
+
+	// Tell User
+	screen << "Press Enter to Continue";
+}
+// *******************************************
+//           waitForEnter
+//    Sends the Frame and waits for Enter
+//********************************************
+void waitForEnter()
+{
+	PROFILE_SCOPE(PROFILE_INPUT_WAIT);
+	TraceSpan span("input");
+
+	// Ignore Previous Enter
+	terminal->input.ignore();
+
+	// Send the Frame before Waiting
+	terminal->output.present();
+
+	// Ignore Enter and Continue Program Execution
+	terminal->input.ignore();
+	terminal->output.inputArrived();
+}
+// *******************************************
+//           drawLines
+//    Draws X number of = (For UI Systems)
+//********************************************
+void drawLines(int lines, ostream &out)
+{
+	SEPARATOR_RUN.write(out, lines);
+	out << endl;
+}
+// *******************************************
+//           confirmStarterSelection
+//    Allows user to confirm their starter
+//		pokemon selection.
+//********************************************
+Status confirmStarterSelection(PlayerData &trainer, int selection)
+{
+	// Clear the Screen
+	clear();
+
+	// Print Pokemon by casting the selection into the a PokemonSpecies ENUM
+	getPokemonIcon(static_cast<PokemonSpecies>(selection - 1));
+
+	// Print Menu Output
+	screen << "You have selected " << DefaultSpeciesNames[selection - 1] << "! Are you sure?" << endl << endl;
+
+	screen << "1. Accept" << endl;
+	screen << "2. Go Back" << endl << endl;
+
+	// Get User Choice
+	int choice = getMenuSelection();
+
+	if (choice == 1)
+	{
+		// User has Accepted the Pokemon, Lets Create It
+		PokemonData starterPokemon;
+		starterPokemon.species = static_cast<PokemonSpecies>(selection - 1);
+
+		// Add that Pokemon to the Trainer's Inventory
+		trainer.addPokemon(starterPokemon);
+		return SUCCESS;
+	}
+	else
+	{
+		// They didn't want this one, so return back to the loop.
+		return FAILED;
+	}
+}
+// *******************************************
+//           selectStarterPokemon
+//    Allows user to select their starter
+//		pokemon selection.
+//********************************************
+void selectStarterPokemon(PlayerData &trainer)
+{
+	// Storage Variable for the Menu Selection
+	int selection;
+
+	// Storage Variable for the Added Pokemon Status ENUM
+	Status addedPokemon = FAILED;
+
+	do
+	{
+		// Clear the Screen
+		clear();
+
+		// Print Menu
+		screen << "Pick your Starter Pokemon: " << endl;
+		screen << "1. Bulbasaur" << endl;
+		screen << "2. Charmander" << endl;
+		screen << "3. Squirtle" << endl;
+
+		// Get Selection
+		selection = getMenuSelection();
+
+		// Confirm Starter Pokemon
+		addedPokemon = confirmStarterSelection(trainer, selection);
+	} while (addedPokemon == FAILED);
+}
+// *******************************************
+//           newGame
+//    Prompts user to input their name and
+//		their rival's name.
+//********************************************
+void newGame(PlayerData &trainer)
+{
+	// Clear the Screen
+	clear();
+
+	// Storage Variable for User Input
+	string input;
+
+	// Get Trainer's Name and append to Trainer Object
+	screen << "Enter your name: ";
+	terminal->output.present();
+	getline(terminal->input, input);
+	trainer.name = input;
+
+	// Clear the Screen
+	clear();
+
+	// Get Rival's Name and append to Trainer Object
+	screen << "Enter your rival's name: ";
+	terminal->output.present();
+	getline(terminal->input, input);
+	trainer.rivalName = input;
+
+	// Move to Select Starter Pokemon
+	selectStarterPokemon(trainer);
+}
+// *******************************************
+//           printStats
+//    Displays all trainer information as well
+//		as information about their pokemon.
+//********************************************
+void printStats(PlayerData &trainer)
+{
+	// Clear the Screen
+	clear();
+
+	// Draw 60 =
+	drawLines(60);
+
+	// Print Trainer and Rival Name
+	screen << "Trainer Name: " << trainer.name << endl;
+	screen << "Rival's Name: " << trainer.rivalName << endl;
+	screen << endl;
+
+	// Print Money on Hand and Number of Pokemon
+	screen << "Money:   " << trainer.money << endl;
+	screen << "Pokemon: " << trainer.pokemonOwned << endl;
+	screen << endl;
+
+	// Print Session Seed (Start with --seed to replay this session)
+	screen << "Seed:    " << gameSeed << endl;
+	screen << endl;
+
+	// If the Trainer has Items, display them
+	if (trainer.hasItems())
+	{
+		screen << "Bag: " << endl;
+		if (trainer.itemsOwned[ELIXIR] > 0)
+		{
+			screen << "Elixir   (Quantity: " << trainer.itemsOwned[ELIXIR] << ") " << endl;
+		}
+
+		if (trainer.itemsOwned[POKEBALL] > 0)
+		{
+			screen << "Pokeball (Quantity: " << trainer.itemsOwned[POKEBALL] << ") " << endl;
+		}
+
+		screen << endl;
+	}
+
+	// Draw 60 =
 	drawLines(60);
+
+	// Pokemon Information
+	for (int i = 0; i < trainer.pokemonOwned; i++)
+	{
+		// Get Current Pokemon for i
+		PokemonData currentPokemon = trainer.pokemon[i];
+
+		// Are they Fainted or Ready to Battle?
+		string status = (currentPokemon.isDead == true ? "Fainted" : "Ready for Combat");
+
+		// Print Status
+		screen << "Name:  " << currentPokemon.name() << endl;
+		screen << "Level: " << currentPokemon.level << endl;
+		screen << "EXP:   " << currentPokemon.exp << endl;
+		screen << "HP:    " << currentPokemon.health << " HP / " << currentPokemon.maxHealth << " HP" << endl;
+		screen << endl;
+		screen << "Status: " << status << endl;
+		screen << endl;
+
+		// Print Icon
+		getPokemonIcon(currentPokemon.species);
+
+		// Draw 60 =
+		drawLines(60);
+	}
+
+	// Press Enter to Continue
+	pressEnterToContinue();
+}
+// *******************************************
+//           pokemonCenterCost
+//    Calculates how many credits it costs to
+//		bring a pokemon back to full health
+//    depending on what it's current health is.
+//********************************************
+int pokemonCenterCost(int health, int maxHealth)
+{
+	int healthToRestore = maxHealth - health;
+
+	// 25 Credits per HP Restored
+	return healthToRestore * 25;
+}
+// *******************************************
+//           pokemonCenterHeal
+//    Attempts to heal selected pokemon.
+//********************************************
+Status pokemonCenterHeal(PlayerData &trainer, int pokemonToHeal)
+{
+	// What Pokemon are we healing (modified to fit 0 based array.)
+	int pokemon = pokemonToHeal - 1;
+
+	// Get Pokemon Data for Pokemon Selected
+	PokemonData current = trainer.pokemon[pokemon];
+
+	// Determine how much it will cost
+	int cost = pokemonCenterCost(current.health, current.maxHealth);
+
+	// Clear the Screen
+	clear();
+
+	// Display Pokemon Information
+	screen << "Pokemon Name: " << current.name() << endl;
+	screen << "Current HP: " << current.health << " HP" << endl << endl;
+
+	// Display Menu to User to inquire about healing this Pokemon
+	screen << "Would you like to restore \"" << current.name() << "\" to full health? (" << current.maxHealth << " HP)" << endl;
+	screen << "It will cost " << cost << " to restore them to full health." << endl << endl;
+
+	screen << "1. Accept" << endl;
+	screen << "2. Decline" << endl;
+
+	// Get User Selection
+	int selection = getMenuSelection();
+
+	// Clear the Screen
+	clear();
+
+	if (selection == 1)
+	{
+		// Attempt to Remove Money from Trainer's Wallet
+		Status removeMoney = trainer.removeMoney(cost);
+
+		// If SUCCESS then they had enough money
+		if (removeMoney == SUCCESS)
+		{
+			// Give 999 Health to Pokemon and set it to Alive (No Pokemon will have more than 999 health)
+			trainer.pokemon[pokemon].giveHealth(999);
+			trainer.pokemon[pokemon].isDead = false;
+
+			// Print Success Message
+			printMessage(makeMessage(CenterHealedMessage, current.name()));
+		}
+		else
+		{
+			// Player did not have enough money.
+			printMessage(makeMessage(CenterNoMoneyMessage, current.name()));
+		}
+
+		// Press Enter to Continue
+		pressEnterToContinue();
+
+		return SUCCESS;
+	}
+	else
+	{
+		return FAILED;
+	}
+}
+// *******************************************
+//           pokemonCenter
+//    Displays the Pokemon Center Menu
+//********************************************
+void pokemonCenter(PlayerData &trainer)
+{
+	// Container for Selection
+	int selection = 0;
+
+	do
+	{
+		// Clear the Screen
+		clear();
+
+		// Display Menu
+		screen << "Pokemon Center (Select Pokemon to Heal): " << endl << endl;
+
+		// Create Menu Entry for each Pokemon in Trainer's Inventory
+		for (int i = 0; i < trainer.pokemonOwned; i++)
+		{
+			// Get Pokemon Data for i
+			PokemonData current = trainer.pokemon[i];
+
+			// Print Pokemon Data on Menu
+			printMessage(makeMessage(CenterEntryMessage, i + 1, current.name(), current.health, current.maxHealth));
+		}
+
+		// Spacing
+		screen << endl;
+
+		screen << "7. Return to Menu" << endl;
+
+		// Get User Input
+		selection = getMenuSelection();
+
+		// If the Selction is not 7 (return to menu) AND (Selection is Greater than ZERO AND Selection is less than or equal to pokemonOwned)
+		if (selection != 7 && (selection > 0 && selection <= trainer.pokemonOwned))
+		{
+			// Send them to get Healed
+			pokemonCenterHeal(trainer, selection);
+		}
+	} while (selection != 7);
+}
+// *******************************************
+//           pokemonMartItem
+//    Attempts the purchase of an item from
+//    the Pokemon Mart.
+//********************************************
+Status pokemonMartItem(PlayerData &trainer, int item)
+{
+	// Clear the Screen
+	clear();
+
+	// Get Item Data for Selected Item (adjusts for zero based array)
+	PokemonItem selectedItem = itemData[item - 1];
+
+	// Print Item Information
+	screen << "Item Name:  " << selectedItem.name << endl;
+	screen << "Item Price: " << selectedItem.price << endl;
+	screen << "Item Description: " << selectedItem.description << endl;
+
+	// Spacing
+	screen << endl;
+
+	// Inquire about purchasing the item
+	screen << "Would you like to buy this item?" << endl;
+
+	// Spacing
+	screen << endl;
+
+	// Menu
+	screen << "1. Purchase" << endl;
+	screen << "2. Decline" << endl;
+
+	// Get User Input
+	int selection = getMenuSelection();
+
+	// Clear the Screen
+	clear();
+
+	if (selection == 1)
+	{
+		// Attempt to add the item to Trainer's Inventory
+		Status addItem = trainer.addItem(static_cast<ItemNames>(item - 1));
+
+		if (addItem == SUCCESS)
+		{
+			// Player had enough money
+			printMessage(makeMessage(MartBoughtMessage, static_cast<ItemNames>(item - 1)));
+		}
+		else
+		{
+			// Player didn't have enough money
+			printMessage(makeMessage(MartNoMoneyMessage, static_cast<ItemNames>(item - 1)));
+		}
+	}
+	else
+	{
+		return FAILED;
+	}
+
+	// Press Enter to Continue
+	pressEnterToContinue();
+
+	return SUCCESS;
+}
+// *******************************************
+//           pokemonMart
+//    Displays the Pokemon Mart Menu
+//********************************************
+void pokemonMart(PlayerData &trainer)
+{
+	// Selection Container
+	int selection = 0;
+
+	do
+	{
+		// Clear the Screen
+		clear();
+
+		// Menu
+		screen << "Pokemon Mart (Select Item to Buy): " << endl;
+		screen << endl;
+
+		// Items
+		screen << "1. Elixir   (Cost: 500)" << endl;
+		screen << "2. Pokeball (Cost: 2000)" << endl;
+		screen << endl;
+
+		screen << "3. Return to Menu" << endl;
+
+		// Get User Input
+		selection = getMenuSelection();
+
+		// If (Selection is NOT 3 and (Selection is greater than ZERO AND Selection is less than or equal to the number of Items in Game))
+		if (selection != 3 && (selection > 0 && selection <= ITEMS_IN_GAME))
+		{
+			// Attempt to buy the item.
+			pokemonMartItem(trainer, selection);
+		}
+	} while (selection != 3);
+}
+// *******************************************
+//           drawBattleUIStatus
+//    Draws Battle UI with Health and Pokemon
+//		Image, but with a passthrough message
+// 		along with waiting for an enter key to
+//    be pressed.
+//********************************************
+void drawBattleUIStatus(PokemonData &attackingPokemon, string_view text)
+{
+	PROFILE_SCOPE(PROFILE_DRAW_BATTLE_STATUS);
+	TraceSpan span("drawBattleUIStatus");
+
+	// Show Attacking Pokemon's Name, Level, and HP
+	drawBattleUIHeader(attackingPokemon, terminal->battleScreen.canvas);
+
+	// Draw Attacking Pokemon
+	getPokemonIcon(attackingPokemon.species, terminal->battleScreen.canvas);
+
+	// Draw 60 =
+	drawLines(60, terminal->battleScreen.canvas);
+
+	// Output Message
+	terminal->battleScreen.canvas << text << endl;
+
+	// Draw 60 =
+	drawLines(60, terminal->battleScreen.canvas);
+
+	// Send only what Changed since the Last Frame
+	terminal->battleScreen.present(screen);
+	terminal->output.battleFrame = true;
+
+	// Press Enter to Continue (the battle waits for it)
+	promptEnter();
+}
+// *******************************************
+//           deadPickNew
+//    Prompts user to select a new pokemon to
+//    replace the currently dead one. This
+//    message will only show up in the event
+//    that there are other pokemon in the
+//    trainer's inventory that aren't dead.
+//    The battle waits for the selection.
+//********************************************
+void deadPickNew(PlayerData &trainer)
+{
+	// Clear the Screen
+	clear();
+
+	// Tell User to pick new Pokemon
+	screen << "Call out a new POKEMON! " << endl;
+
+	// Print All Pokemon in Trainer's Inventory
+	for (int i = 0; i < trainer.pokemonOwned; i++)
+	{
+		// Only Print Pokemon that are not Dead
+		if (trainer.pokemon[i].isDead == false)
+		{
+			// Print Pokemon Stats
+			screen << i + 1 << ". " << left << setfill(' ') << setw(15) << trainer.pokemon[i].name();
+			screen << " LV: " << trainer.pokemon[i].level;
+			screen << " HP: " << trainer.pokemon[i].health;
+			screen << " HP / " << trainer.pokemon[i].maxHealth << " HP" << endl;
+		}
+	}
+
+	// Ask which one (the Battle Core rejects dead ones)
+	promptSelection();
+}
+// *******************************************
+//           printMessage
+//    Writes a message as one line of text,
+//    formatted in a buffer on the stack.
+//********************************************
+void printMessage(const Message &message, ostream &out)
+{
+	char text[MESSAGE_TEXT_CAPACITY];
+	out << message.format(text) << endl;
+}
+// *******************************************
+//           decodeMessage
+//    Reads a binary message record back into
+//    a Message. Names point into the record.
+//    Returns the bytes used, 0 if the record
+//    is cut short or not a message.
+//********************************************
+size_t decodeMessage(span<const uint8_t> record, Message &message)
+{
+	if (record.empty() || record[0] >= MESSAGE_IDS)
+	{
+		return 0;
+	}
+
+	message.layout = MessageLayouts[record[0]];
+
+	size_t at = 1;
+	for (int slot = 0; slot < message.layout->slotCount; slot++)
+	{
+		MessageValue &value = message.values[slot];
+		value = MessageValue();
+
+		if (at >= record.size())
+		{
+			return 0;
+		}
+
+		switch (message.layout->slots[slot])
+		{
+		case SLOT_NAME:
+		{
+			size_t length = record[at++];
+			if (at + length > record.size())
+			{
+				return 0;
+			}
+			value.text = string_view(reinterpret_cast<const char *>(record.data() + at), length);
+			at += length;
+			break;
+		}
+		case SLOT_MOVE:
+		{
+			int code = record[at++];
+			if (code >= POKEMON_IN_GAME * MOVES)
+			{
+				return 0;
+			}
+			value = MessageValue(MessageMove{ static_cast<PokemonSpecies>(code / MOVES), code % MOVES });
+			break;
+		}
+		case SLOT_ITEM:
+		{
+			int code = record[at++];
+			if (code >= ITEMS_IN_GAME)
+			{
+				return 0;
+			}
+			value = MessageValue(static_cast<ItemNames>(code));
+			break;
+		}
+		case SLOT_NUMBER:
+		{
+			uint64_t zigzag = 0;
+			for (int shift = 0; ; shift += 7)
+			{
+				if (at >= record.size() || shift > 63)
+				{
+					return 0;
+				}
+
+				uint8_t byte = record[at++];
+				zigzag |= static_cast<uint64_t>(byte & 0x7F) << shift;
+				if ((byte & 0x80) == 0)
+				{
+					break;
+				}
+			}
+			value.number = static_cast<long long>(zigzag >> 1) ^ -static_cast<long long>(zigzag & 1);
+			break;
+		}
+		}
+	}
+
+	return at;
+}
+// *******************************************
+//           arenaNumber
+//    to_string into the given memory
+//********************************************
+pmr::string arenaNumber(long long value, pmr::memory_resource *memory)
+{
+	char digits[24];
+	char *end = to_chars(digits, digits + sizeof(digits), value).ptr;
+
+	return pmr::string(digits, end, memory);
+}
+// *******************************************
+//           philoxBlock
+//    Philox 4x32-10 counter based generator.
+//    Turns one 128 bit counter and a 64 bit
+//    key into four random numbers. The same
+//    counter and key always give the same
+//    numbers, so any draw can be recomputed
+//    on its own.
+//********************************************
+void philoxBlock(uint64_t key, const uint32_t counter[4], uint32_t out[4])
+{
+	// Multipliers and Key Increments (Weyl Sequence)
+	const uint32_t PHILOX_M0 = 0xD2511F53;
+	const uint32_t PHILOX_M1 = 0xCD9E8D57;
+	const uint32_t PHILOX_W0 = 0x9E3779B9;
+	const uint32_t PHILOX_W1 = 0xBB67AE85;
+
+	uint32_t k0 = static_cast<uint32_t>(key);
+	uint32_t k1 = static_cast<uint32_t>(key >> 32);
+
+	uint32_t c0 = counter[0];
+	uint32_t c1 = counter[1];
+	uint32_t c2 = counter[2];
+	uint32_t c3 = counter[3];
+
+	// 10 Rounds
+	for (int round = 0; round < 10; round++)
+	{
+		uint64_t product0 = static_cast<uint64_t>(PHILOX_M0) * c0;
+		uint64_t product1 = static_cast<uint64_t>(PHILOX_M1) * c2;
+
+		c0 = static_cast<uint32_t>(product1 >> 32) ^ c1 ^ k0;
+		c1 = static_cast<uint32_t>(product1);
+		c2 = static_cast<uint32_t>(product0 >> 32) ^ c3 ^ k1;
+		c3 = static_cast<uint32_t>(product0);
+
+		k0 += PHILOX_W0;
+		k1 += PHILOX_W1;
+	}
+
+	out[0] = c0;
+	out[1] = c1;
+	out[2] = c2;
+	out[3] = c3;
+}
+// *******************************************
+//           splitMixBlock
+//    Cheaper counter based generator built on
+//    the SplitMix64 finalizer. Weaker than
+//    Philox but roughly twice as fast.
+//********************************************
+void splitMixBlock(uint64_t key, const uint32_t counter[4], uint32_t out[4])
+{
+	auto mix = [](uint64_t z)
+	{
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+		return z ^ (z >> 31);
+	};
+
+	const uint64_t GOLDEN_GAMMA = 0x9E3779B97F4A7C15ULL;
+
+	uint64_t block = (static_cast<uint64_t>(counter[1]) << 32) | counter[0];
+	uint64_t stream = (static_cast<uint64_t>(counter[3]) << 32) | counter[2];
+
+	uint64_t base = mix(key ^ mix(stream + GOLDEN_GAMMA)) + block * 2 * GOLDEN_GAMMA;
+	uint64_t first = mix(base + GOLDEN_GAMMA);
+	uint64_t second = mix(base + 2 * GOLDEN_GAMMA);
+
+	out[0] = static_cast<uint32_t>(first);
+	out[1] = static_cast<uint32_t>(first >> 32);
+	out[2] = static_cast<uint32_t>(second);
+	out[3] = static_cast<uint32_t>(second >> 32);
+}
+// *******************************************
+//           randomEngineByName
+//    Looks up a Random Block Function by the
+//    name used on the command line.
+//********************************************
+RandomBlockFunction randomEngineByName(const string &name)
+{
+	if (name == "philox")
+	{
+		return philoxBlock;
+	}
+	else if (name == "splitmix")
+	{
+		return splitMixBlock;
+	}
+
+	return nullptr;
+}
+// *******************************************
+//           createWildBattle
+//    Creates a Battle State against a random
+//    wild opponent close to the level of the
+//    trainer's primary pokemon. Every roll in
+//    the battle comes from the given stream.
+//********************************************
+BattleState createWildBattle(PlayerData &trainer, RandomStream random)
+{
+	// Create Battle
+	BattleState battle;
+	battle.trainer = &trainer;
+	battle.random = random;
+
+	// Get Random Species 0 - 9
+	int opponentSpecies = battleRoll(battle, POKEMON_IN_GAME);
+
+	// Determine the Highest and Lowest Levels possible
+	int lowestLevel = trainer.pokemon[0].level - 3;
+	int highestLevel = trainer.pokemon[0].level + 4;
+
+	// Generate Level
+	int opponentLevel = battleRoll(battle, highestLevel - lowestLevel) + lowestLevel;
+
+	// Make sure level isn't less than 1
+	if (opponentLevel < 1) opponentLevel = 1;
+
+	// Create Opponent (Wild Pokemon go by their Species Name)
+	battle.opponent.nickname = 0;
+	battle.opponent.level = opponentLevel;
+	battle.opponent.health = opponentLevel * 5;
+	battle.opponent.maxHealth = battle.opponent.health;
+	battle.opponent.species = static_cast<PokemonSpecies>(opponentSpecies);
+
+	// Determine Who Attacks First
+	battle.computerFirst = (battleRoll(battle, 2) == 0);
+
+	return battle;
+}
+// *******************************************
+//           beginBattle
+//    Resolves anything that happens before
+//    the Player's first turn. If the Computer
+//    won the coin toss it attacks here.
+//********************************************
+BattleEvents beginBattle(BattleState &battle)
+{
+	// Container for Events
+	BattleEvents events;
+
+	if (battle.computerFirst && battle.phase == PHASE_ACTION)
+	{
+		computerAttack(battle, events);
+	}
+
+	return events;
+}
+// *******************************************
+//           resolveTurn
+//    Resolves one full turn of the battle
+//    (the Player's action followed by the
+//    Computer's attack) without any I/O and
+//    returns everything that happened.
+//********************************************
+BattleEvents resolveTurn(BattleState &battle, BattleAction action)
+{
+	// Container for Events
+	BattleEvents events;
+
+	// Nothing left to Resolve
+	if (battle.phase == PHASE_OVER)
+	{
+		return events;
+	}
+
+	// The Player's Pokemon Fainted, the only valid action is calling out a new one
+	if (battle.phase == PHASE_REPLACE)
+	{
+		if (action.type == ACTION_SWAP)
+		{
+			swapPokemon(battle, action.slot, events);
+		}
+
+		return events;
+	}
+
+	// Count the Turn
+	battle.turns++;
+
+	// Player's Action
+	switch (action.type)
+	{
+	case ACTION_ATTACK:
+		trainerAttack(battle, action.attackType, events);
+		break;
+	case ACTION_ELIXIR:
+		useElixir(battle, events);
+		break;
+	case ACTION_POKEBALL:
+		throwPokeball(battle, events);
+		break;
+	case ACTION_SWAP:
+		swapPokemon(battle, action.slot, events);
+		break;
+	case ACTION_FLEE:
+		fleeBattle(battle, events);
+		break;
+	}
+
+	// Computer's Attack (if the Player didn't end the battle)
+	if (battle.phase == PHASE_ACTION)
+	{
+		computerAttack(battle, events);
+	}
+
+	return events;
+}
+// *******************************************
+//           battleRoll
+//    Draws a random number between 0 and
+//    range - 1 for the battle.
+//********************************************
+int battleRoll(BattleState &battle, int range)
+{
+	return battle.random.roll(range);
+}
+// *******************************************
+//           attackPower
+//    Rolls the damage for an attack of the
+//    given type from a pokemon of the given
+//    level.
+//********************************************
+int attackPower(BattleState &battle, int level, Status attackType)
+{
+	if (attackType == NORMAL)
+	{
+		// Number between 0 and 5 + 3 * (level * .25)
+		return ((battleRoll(battle, 5) + 3) * (level * 0.25));
+	}
+	else
+	{
+		// Number between 0 and 9 * (level * .25)
+		return (battleRoll(battle, 9) * (level * 0.25));
+	}
+}
+// *******************************************
+//           computerAttack
+//    Processes Computer Attack
+//********************************************
+void computerAttack(BattleState &battle, BattleEvents &events)
+{
+	PROFILE_SCOPE(PROFILE_COMPUTER_ATTACK);
+
+	// 20% Chance of Special Attack
+	Status attackType = (battleRoll(battle, 10) >= 8) ? SPECIAL : NORMAL;
+
+	// Roll Damage
+	int damage = attackPower(battle, battle.opponent.level, attackType);
+
+	// Hit Player
+	BattleEvent attack;
+	attack.type = EVENT_ATTACK;
+	attack.actor = COMPUTER;
+	attack.move = (attackType == SPECIAL) ? 1 : 0;
+	attack.amount = damage;
+	attack.result = battle.trainer->pokemon[0].takeDamage(damage);
+	events.add(attack);
+
+	// If the Computer killed the trainer's current Pokemon
+	if (attack.result == DEAD)
+	{
+		// Do we have any replacement pokemon?
+		if (battle.trainer->alivePokemon() != 0)
+		{
+			battle.phase = PHASE_REPLACE;
+		}
+		else
+		{
+			computerWin(battle, events);
+		}
+	}
+}
+// *******************************************
+//           trainerAttack
+//    Attacks opponent with the trainer's
+//    current pokemon.
+//********************************************
+void trainerAttack(BattleState &battle, Status attackType, BattleEvents &events)
+{
+	PROFILE_SCOPE(PROFILE_TRAINER_ATTACK);
+
+	// Roll Damage
+	int damage = attackPower(battle, battle.trainer->pokemon[0].level, attackType);
+
+	// Hit Attacking Pokemon
+	BattleEvent attack;
+	attack.type = EVENT_ATTACK;
+	attack.actor = PLAYER;
+	attack.move = (attackType == SPECIAL) ? 1 : 0;
+	attack.amount = damage;
+	attack.result = battle.opponent.takeDamage(damage);
+	events.add(attack);
+
+	// If the Player kills the Computer
+	if (attack.result == DEAD)
+	{
+		playerWin(battle, events);
+	}
+}
+// *******************************************
+//           useElixir
+//    Gives the current pokemon 20 HP if the
+//    trainer has an Elixir.
+//********************************************
+void useElixir(BattleState &battle, BattleEvents &events)
+{
+	BattleEvent elixir;
+	elixir.type = EVENT_ELIXIR;
+	elixir.amount = 20;
+	elixir.result = battle.trainer->removeItem(ELIXIR);
+
+	if (elixir.result == SUCCESS)
+	{
+		// Give Current Pokemon 20 HP
+		battle.trainer->pokemon[0].giveHealth(elixir.amount);
+	}
+
+	events.add(elixir);
+}
+// *******************************************
+//           throwPokeball
+//    Attempts to throw a pokeball and catch
+//    the opponent.
+//********************************************
+void throwPokeball(BattleState &battle, BattleEvents &events)
+{
+	BattleEvent pokeball;
+	pokeball.type = EVENT_POKEBALL;
+	pokeball.result = battle.trainer->removeItem(POKEBALL);
+
+	// 1 / 10 (10% Chance)
+	if (pokeball.result == SUCCESS)
+	{
+		pokeball.result = FAILED;
+
+		// Attempt to Catch Pokemon (Fails if the Trainer already has 6 Pokemon)
+		if (battleRoll(battle, 10) == 0 && battle.trainer->addPokemon(battle.opponent) == SUCCESS)
+		{
+			pokeball.result = CAUGHT;
+
+			// End Battle
+			battle.phase = PHASE_OVER;
+			battle.outcome = CAUGHT;
+		}
+	}
+
+	events.add(pokeball);
 }
 // *******************************************
-//           drawBattleUI
-//    Draws the entire Battle UI
+//           swapPokemon
+//    Takes selected pokemon and moves it to
+//    the front of the Pokemon array for the
+//    trainer and moves the previously default
+//    pokemon to the place of the selected
+//    pokemon.
 //********************************************
-void drawBattleUI(PlayerData &trainer, PokemonData &attackingPokemon, MenuLocation location, Status &battleStatus)
+void swapPokemon(BattleState &battle, int slot, BattleEvents &events)
 {
-	// Clear Screen
-	clear();
+	PlayerData &trainer = *battle.trainer;
 
-	// Draw Battle Header
-	drawBattleUIHeader(attackingPokemon);
+	BattleEvent swap;
+	swap.type = EVENT_SWAP;
+	swap.slot = slot;
+	swap.result = FAILED;
 
-	// Display Opponent Pokemon
-	getPokemonIcon(attackingPokemon.species);
+	// If the Pokemon we are trying to swap to exists and is not dead
+	if (slot >= 0 && slot < trainer.pokemonOwned && trainer.pokemon[slot].isDead != true)
+	{
+		// Exchange the Zero Index (first Pokemon) with the Swap Pokemon
+		PokemonData currentPokemon = trainer.pokemon[0];
+		trainer.pokemon[0] = trainer.pokemon[slot];
+		trainer.pokemon[slot] = currentPokemon;
 
-	// Draw Battle Footer
-	drawBattleUIFooter(location, trainer);
+		swap.result = SUCCESS;
+
+		// A replacement was called out, so the battle carries on
+		if (battle.phase == PHASE_REPLACE)
+		{
+			battle.phase = PHASE_ACTION;
+		}
+	}
 
-	// Send Command to Battle UI Controller
-	battleUIController(trainer, attackingPokemon, location, getMenuSelection(), battleStatus);
+	events.add(swap);
 }
 // *******************************************
-//           clear
-//    Cross-Platform Console Clearing
+//           fleeBattle
+//    Attempts to flee from battle.
 //********************************************
-void clear()
+void fleeBattle(BattleState &battle, BattleEvents &events)
 {
-	system("cls");
+	BattleEvent flee;
+	flee.type = EVENT_FLEE;
+	flee.result = FAILED;
+
+	// 50/50 Chance of Success
+	if (battleRoll(battle, 2) == 0)
+	{
+		flee.result = SUCCESS;
+
+		// End Battle
+		battle.phase = PHASE_OVER;
+		battle.outcome = BATTLE_END;
+	}
+
+	events.add(flee);
 }
 // *******************************************
-//           pressEntertoContinue
-//    Pause until User Presses Enter
+//           playerWin
+//    Ends the battle in the Player's favour
+//    and gives out money and experience.
 //********************************************
-void pressEnterToContinue()
+void playerWin(BattleState &battle, BattleEvents &events)
 {
-	// Ignore Previous Enter
-	cin.ignore();
+	PlayerData &trainer = *battle.trainer;
 
-	// New Line
-	cout << endl;
+	// Determine how much EXP and Money to Give Player
+	BattleEvent victory;
+	victory.type = EVENT_VICTORY;
+	victory.amount = battle.opponent.level * 15;
+	victory.money = battle.opponent.level * 200;
+	events.add(victory);
 
-	// Tell User
-	cout << "Press Enter to Continue";
+	// Add Money to Trainer's Wallet
+	trainer.money += victory.money;
 
-	// Ignore Enter and Continue Program Execution
-	cin.ignore();
+	// Give EXP and check if the Pokemon Leveled Up
+	if (trainer.pokemon[0].addExp(victory.amount) == LEVELUP)
+	{
+		BattleEvent levelUp;
+		levelUp.type = EVENT_LEVELUP;
+		levelUp.amount = trainer.pokemon[0].level;
+		events.add(levelUp);
+	}
+
+	// End Battle
+	battle.phase = PHASE_OVER;
+	battle.outcome = PLAYER;
 }
 // *******************************************
-//           drawLines
-//    Draws X number of = (For UI Systems)
+//           computerWin
+//    Ends the battle in the Computer's favour
+//    and takes money from the Player.
 //********************************************
-void drawLines(int lines)
+void computerWin(BattleState &battle, BattleEvents &events)
 {
-	for (int i = 0; i < lines; i++)
+	PlayerData &trainer = *battle.trainer;
+
+	// Determine how much money will be taken from the Player
+	BattleEvent defeat;
+	defeat.type = EVENT_DEFEAT;
+	defeat.actor = COMPUTER;
+	defeat.money = battle.opponent.level * 25;
+	events.add(defeat);
+
+	// Attempt to remove money from the Player
+	if (trainer.removeMoney(defeat.money) == FAILED)
 	{
-		cout << "=";
+		// The trainer doesn't have enough money to lose, so set it to zero.
+		trainer.money = 0;
 	}
-	cout << endl;
+
+	// End Battle
+	battle.phase = PHASE_OVER;
+	battle.outcome = COMPUTER;
 }
 // *******************************************
-//           confirmStarterSelection
-//    Allows user to confirm their starter
-//		pokemon selection.
+//           drawBattleEvent
+//    Turns one event of a turn into a status
+//    message on the Battle UI.
 //********************************************
-Status confirmStarterSelection(PlayerData &trainer, int selection)
+void drawBattleEvent(BattleState &battle, BattleEvent &event)
 {
-	// Clear the Screen
-	clear();
+	PlayerData &trainer = *battle.trainer;
+	PokemonData &attackingPokemon = battle.opponent;
 
-	// Print Pokemon by casting the selection into the a PokemonSpecies ENUM
-	getPokemonIcon(static_cast<PokemonSpecies>(selection - 1));
+	// The Message is Filled in Place and Written into the Text Buffer (No Heap)
+	Message message;
+	char text[MESSAGE_TEXT_CAPACITY];
 
-	// Print Menu Output
-	cout << "You have selected " << DefaultSpeciesNames[selection - 1] << "! Are you sure?" << endl << endl;
+	// Whose Pokemon the Status Screen Shows
+	PokemonData *shown = &attackingPokemon;
 
-	cout << "1. Accept" << endl;
-	cout << "2. Go Back" << endl << endl;
+	switch (event.type)
+	{
+	case EVENT_ATTACK:
+		if (event.actor == COMPUTER)
+		{
+			MessageMove move = { attackingPokemon.species, event.move };
 
-	// Get User Choice
-	int choice = getMenuSelection();
+			// Based on the result of hitting the player
+			switch (event.result)
+			{
+			case HIT:
+				message = makeMessage(WildHitMessage, attackingPokemon.name(), move, trainer.pokemon[0].name(), event.amount);
+				break;
+			case DEAD:
+				message = makeMessage(WildFaintedMessage, attackingPokemon.name(), move, trainer.pokemon[0].name());
+				break;
+			default:
+				message = makeMessage(WildMissedMessage, attackingPokemon.name(), move);
+				break;
+			}
+		}
+		else
+		{
+			MessageMove move = { trainer.pokemon[0].species, event.move };
 
-	if (choice == 1)
+			// Based on the result of hitting the opponent
+			switch (event.result)
+			{
+			case HIT:
+				message = makeMessage(AttackHitMessage, trainer.pokemon[0].name(), move, attackingPokemon.name(), event.amount);
+				break;
+			case DEAD:
+				message = makeMessage(AttackFaintedMessage, trainer.pokemon[0].name(), move, attackingPokemon.name());
+				break;
+			default:
+				message = makeMessage(AttackMissedMessage, trainer.pokemon[0].name(), move);
+				break;
+			}
+		}
+		break;
+	case EVENT_ELIXIR:
+		// Without Elixir the Player doesn't have any of that item
+		message = (event.result == SUCCESS) ? makeMessage(ElixirUsedMessage, event.amount, trainer.pokemon[0].name()) : makeMessage(NoItemMessage);
+		break;
+	case EVENT_POKEBALL:
+		if (event.result == CAUGHT)
+		{
+			message = makeMessage(CaughtMessage, trainer.name, attackingPokemon.name());
+		}
+		else if (event.result == FAILED)
+		{
+			// Failed to Capture Pokemon or Trainer already has 6 Pokemon
+			message = makeMessage(BrokeFreeMessage, trainer.name);
+		}
+		else
+		{
+			// Player doesn't have any Pokeballs
+			message = makeMessage(NoItemMessage);
+		}
+		break;
+	case EVENT_SWAP:
+		if (event.result == SUCCESS)
+		{
+			// The Swapped Pokemon is now at the front
+			message = makeMessage(SwappedMessage, trainer.pokemon[event.slot].name(), trainer.pokemon[0].name());
+			shown = &trainer.pokemon[0];
+		}
+		else
+		{
+			message = makeMessage(CannotSwapMessage);
+		}
+		break;
+	case EVENT_FLEE:
+		message = (event.result == SUCCESS) ? makeMessage(FledMessage) : makeMessage(CannotFleeMessage);
+		break;
+	case EVENT_VICTORY:
+		message = makeMessage(VictoryMessage, trainer.name, attackingPokemon.name(), trainer.pokemon[0].name(), event.amount, trainer.name, event.money);
+		break;
+	case EVENT_LEVELUP:
+		message = makeMessage(LevelUpMessage, trainer.pokemon[0].name(), event.amount);
+		shown = &trainer.pokemon[0];
+		break;
+	case EVENT_DEFEAT:
+		message = makeMessage(DefeatMessage, trainer.name, attackingPokemon.name(), trainer.name, event.money);
+		break;
+	}
+
+	drawBattleUIStatus(*shown, message.format(text));
+}
+// *******************************************
+//           mainBattleLoop
+//    Battle Loop for Pokemon Battle System.
+//    The battle itself is a coroutine, this
+//    loop only reads whatever it waits for
+//    and resumes it.
+//********************************************
+void mainBattleLoop(BattleState &battle)
+{
+	BattleInput input;
+	BattleTask task = playBattle(battle, input);
+
+	// Run until the First Prompt
+	task.handle.resume();
+
+	// Are We Battling?
+	while (!task.handle.done())
 	{
-		// User has Accepted the Pokemon, Lets Create It
-		PokemonData starterPokemon;
-		starterPokemon.name = DefaultSpeciesNames[selection - 1];
-		starterPokemon.species = static_cast<PokemonSpecies>(selection - 1);
+		if (input.waiting == INPUT_SELECTION)
+		{
+			input.value = readSelection();
+		}
+		else
+		{
+			waitForEnter();
+			input.value = 0;
+		}
 
-		// Add that Pokemon to the Trainer's Inventory
-		trainer.addPokemon(starterPokemon);
-		return SUCCESS;
+		task.handle.resume();
+	}
+}
+// *******************************************
+//           playBattle
+//    One whole battle as a coroutine. It
+//    draws, then suspends whenever it needs
+//    the Player, and the Battle Core resolves
+//    every turn in between.
+//********************************************
+BattleTask playBattle(BattleState &battle, BattleInput &input)
+{
+	PlayerData &trainer = *battle.trainer;
+
+	// Create Status Message (A wild POKEMON_NAME appeared! GO! PRIMARY_NAME!)
+	{
+		char text[MESSAGE_TEXT_CAPACITY];
+		drawBattleUIStatus(battle.opponent, makeMessage(BattleStartMessage, battle.opponent.name(), trainer.pokemon[0].name()).format(text));
+	}
+	co_await input.enter();
+
+	// The Computer may attack before the Player's first turn
+	BattleEvents events = beginBattle(battle);
+
+	while (true)
+	{
+		// One Span per Turn: the last Turn's Events being Shown, then this one being Picked and Resolved
+		TraceSpan turn("turn", battle.turns);
+
+		// Show what Happened
+		for (int i = 0; i < events.eventCount; i++)
+		{
+			drawBattleEvent(battle, events.events[i]);
+			co_await input.enter();
+		}
+
+		if (battle.phase == PHASE_OVER)
+		{
+			break;
+		}
+
+		// Container for the Player's Choice
+		BattleAction action;
+
+		if (battle.phase == PHASE_REPLACE)
+		{
+			// Tell Trainer to Pick a New One
+			deadPickNew(trainer);
+			action.type = ACTION_SWAP;
+			action.slot = co_await input.selection() - 1;
+		}
+		else
+		{
+			// Player walks the Battle Menus until they Pick an Action
+			MenuLocation location = OVERVIEW;
+			bool picked = false;
+
+			while (!picked)
+			{
+				// Draw the Menu (Timed apart from the wait for input)
+				auto drawStart = chrono::steady_clock::now();
+				drawBattleUI(trainer, battle.opponent, location);
+				auto drawn = chrono::steady_clock::now() - drawStart;
+
+				int selection = co_await input.selection();
+
+				// Move On and Count what it Cost
+				auto moveStart = chrono::steady_clock::now();
+				MenuLocation from = location;
+				picked = battleUIController(location, selection, action);
+				auto moved = chrono::steady_clock::now() - moveStart;
+
+				menuStatistics->add(from, picked ? MENU_LOCATIONS : location, chrono::duration_cast<chrono::nanoseconds>(drawn + moved).count());
+			}
+		}
+
+		// Resolve the Turn
+		{
+			LatencyTimer timer(terminal->latency.metrics[LATENCY_TURN]);
+			events = resolveTurn(battle, action);
+		}
+	}
+}
+// *******************************************
+//           pokemonBattleSetup
+//    Creates Opponent for the Pokemon Battle
+//********************************************
+void pokemonBattleSetup(PlayerData &trainer)
+{
+	TraceSpan span("pokemonBattleSetup");
+
+	// Clear Screen
+	clear();
+
+	// Create Battle against a Random Opponent
+	// Battles are numbered so a replay with the same seed rolls the same numbers
+	BattleState battle = createWildBattle(trainer, RandomStream(gameSeed, battlesStarted++));
+
+	// Begin Loop
+	mainBattleLoop(battle);
+}
+// *******************************************
+//           simulatedAction
+//    Picks the action a simple scripted
+//    Player takes during a simulated battle.
+//********************************************
+BattleAction simulatedAction(BattleState &battle)
+{
+	PlayerData &trainer = *battle.trainer;
+	PokemonData &current = trainer.pokemon[0];
+
+	BattleAction action;
+
+	if (battle.phase == PHASE_REPLACE)
+	{
+		// Call out the first Pokemon that can still fight
+		action.type = ACTION_SWAP;
+		for (int i = 0; i < trainer.pokemonOwned; i++)
+		{
+			if (trainer.pokemon[i].isDead == false)
+			{
+				action.slot = i;
+				break;
+			}
+		}
+	}
+	else if (trainer.itemsOwned[POKEBALL] > 0 && battle.opponent.health * 2 <= battle.opponent.maxHealth)
+	{
+		// Opponent is weakened, try to catch it
+		action.type = ACTION_POKEBALL;
+	}
+	else if (trainer.itemsOwned[ELIXIR] > 0 && current.health * 4 <= current.maxHealth)
+	{
+		// Running low on HP
+		action.type = ACTION_ELIXIR;
 	}
 	else
 	{
-		// They didn't want this one, so return back to the loop.
-		return FAILED;
+		// Normal attacks do more damage on average than Special ones
+		action.type = ACTION_ATTACK;
+		action.attackType = NORMAL;
 	}
+
+	return action;
 }
 // *******************************************
-//           selectStarterPokemon
-//    Allows user to select their starter
-//		pokemon selection.
+//           simulateBattle
+//    Plays one wild battle from start to end
+//    with no UI and adds it to the result.
 //********************************************
-void selectStarterPokemon(PlayerData &trainer)
+void simulateBattle(const PlayerData &templateTrainer, RandomStream random, SimulationResult &result)
 {
-	// Storage Variable for the Menu Selection
-	int selection;
+	// Each Battle starts from a fresh copy of the Trainer
+	PlayerData trainer = templateTrainer;
+	BattleState battle = createWildBattle(trainer, random);
 
-	// Storage Variable for the Added Pokemon Status ENUM
-	Status addedPokemon = FAILED;
+	BattleEvents events = beginBattle(battle);
 
-	do
+	while (true)
 	{
-		// Clear the Screen
-		clear();
+		// Tally EXP Earned
+		for (int i = 0; i < events.eventCount; i++)
+		{
+			if (events.events[i].type == EVENT_VICTORY)
+			{
+				result.exp += events.events[i].amount;
+			}
+		}
 
-		// Print Menu
-		cout << "Pick your Starter Pokemon: " << endl;
-		cout << "1. Bulbasaur" << endl;
-		cout << "2. Charmander" << endl;
-		cout << "3. Squirtle" << endl;
+		if (battle.phase == PHASE_OVER)
+		{
+			break;
+		}
 
-		// Get Selection
-		selection = getMenuSelection();
+		events = resolveTurn(battle, simulatedAction(battle));
+	}
 
-		// Confirm Starter Pokemon
-		addedPokemon = confirmStarterSelection(trainer, selection);
-	} while (addedPokemon == FAILED);
+	// Tally Outcome
+	result.battles++;
+	result.turns += battle.turns;
+	result.money += trainer.money - templateTrainer.money;
+
+	switch (battle.outcome)
+	{
+	case PLAYER:
+		result.wins++;
+		break;
+	case COMPUTER:
+		result.losses++;
+		break;
+	case CAUGHT:
+		result.caught++;
+		break;
+	default:
+		result.fled++;
+		break;
+	}
 }
 // *******************************************
-//           newGame
-//    Prompts user to input their name and
-//		their rival's name.
+//           simulateBattles
+//    Plays config.battles wild battles spread
+//    over every core by the work stealing
+//    pool. Battle i always uses stream i of
+//    config.seed, so the totals don't depend
+//    on scheduling.
 //********************************************
-void newGame(PlayerData &trainer)
+SimulationResult simulateBattles(const SimulationConfig &config)
 {
-	// Clear the Screen
-	clear();
+	// Battles handed out per Task
+	const int BATTLES_PER_TASK = 256;
+
+	// Create the Trainer every Battle starts from
+	PlayerData trainer = simulationTrainer(config);
+
+	// Split the Battles into Tasks
+	WorkStealingPool pool(config.threads);
+	int tasks = (config.battles + BATTLES_PER_TASK - 1) / BATTLES_PER_TASK;
+
+	// One Result per Worker so they never share a cache line
+	vector<SimulationResult> workerResults(pool.threadCount);
+
+	pool.run(tasks, [&](int worker, int task)
+	{
+		int first = task * BATTLES_PER_TASK;
+		int last = min(first + BATTLES_PER_TASK, config.battles);
+
+		for (int i = first; i < last; i++)
+		{
+			simulateBattle(trainer, RandomStream(config.seed, i), workerResults[worker]);
+		}
+	});
+
+	// Merge Results
+	SimulationResult total;
+	for (int i = 0; i < pool.threadCount; i++)
+	{
+		total.merge(workerResults[i]);
+	}
+
+	return total;
+}
+// *******************************************
+//           simulationTrainer
+//    Creates the Trainer every simulated
+//    battle starts from.
+//********************************************
+PlayerData simulationTrainer(const SimulationConfig &config)
+{
+	PlayerData trainer;
+	trainer.name = "Simulator";
+	trainer.itemsOwned[ELIXIR] = config.elixirs;
+	trainer.itemsOwned[POKEBALL] = config.pokeballs;
+
+	PokemonData pokemon;
+	pokemon.species = config.species;
+	pokemon.level = config.level;
+	pokemon.health = config.level * 5;
+	pokemon.maxHealth = config.level * 5;
+	trainer.addPokemon(pokemon);
+
+	return trainer;
+}
+// *******************************************
+//           simulateCoroutineBattles
+//    Plays config.battles battles as battle
+//    coroutines on the Battle Scheduler, with
+//    the full UI drawn (and thrown away) and
+//    a scripted Player typing menu numbers.
+//    Every battle is started and left waiting
+//    for input first, so all of them are in
+//    flight at once when memory is measured.
+//********************************************
+SimulationResult simulateCoroutineBattles(const SimulationConfig &config, CoroutineBenchmark &benchmark)
+{
+	PlayerData trainer = simulationTrainer(config);
+	vector<SimulationResult> shardResults(config.threads);
+
+	BattleScheduler scheduler;
+	scheduler.finished = [&](BattleSession &session, int shard)
+	{
+		SimulationResult &result = shardResults[shard];
+		BattleState &battle = session.battle;
+
+		result.battles++;
+		result.turns += battle.turns;
+		result.money += session.trainer.money - trainer.money;
+
+		switch (battle.outcome)
+		{
+		case PLAYER:
+			result.wins++;
+			result.exp += battle.opponent.level * 15;
+			break;
+		case COMPUTER:
+			result.losses++;
+			break;
+		case CAUGHT:
+			result.caught++;
+			break;
+		default:
+			result.fled++;
+			break;
+		}
+	};
+	scheduler.start(config.threads);
 
-	// Storage Variable for User Input
-	string input;
+	// Start Every Battle and leave it Waiting
+	size_t residentBefore = residentBytes();
+	long long framesBefore = battleFrameBytes;
 
-	// Get Trainer's Name and append to Trainer Object
-	cout << "Enter your name: ";
-	getline(cin, input);
-	trainer.name = input;
+	vector<BattleSession> sessions(config.battles);
+	for (int i = 0; i < config.battles; i++)
+	{
+		BattleSession &session = sessions[i];
+		session.trainer = trainer;
+		session.battle = createWildBattle(session.trainer, RandomStream(config.seed, i));
+		session.task = playBattle(session.battle, session.input);
+		scheduler.spawn(session);
+	}
+	scheduler.drain();
 
-	// Clear the Screen
-	clear();
+	benchmark.framesInFlight = battleFrames;
+	benchmark.frameBytes = (battleFrameBytes - framesBefore) / max(1, config.battles);
+	benchmark.sessionBytes = sizeof(BattleSession);
+	benchmark.residentBytes = (residentBytes() - residentBefore) / max(1, config.battles);
 
-	// Get Rival's Name and append to Trainer Object
-	cout << "Enter your rival's name: ";
-	getline(cin, input);
-	trainer.rivalName = input;
+	// Now let the Scripted Player Answer and Play them Out
+	scheduler.answer = scriptedBattleInput;
 
-	// Move to Select Starter Pokemon
-	selectStarterPokemon(trainer);
+	auto start = chrono::steady_clock::now();
+	for (BattleSession &session : sessions)
+	{
+		scriptedBattleInput(session);
+		scheduler.ready(session);
+	}
+	scheduler.drain();
+	double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+	scheduler.stop();
+
+	for (unique_ptr<BattleScheduler::Shard> &shard : scheduler.shards)
+	{
+		benchmark.resumes += shard->resumes;
+		benchmark.menuStatistics.merge(shard->menuStatistics);
+		benchmark.latency.merge(shard->terminal.latency);
+	}
+	benchmark.resumeNanos = seconds * 1e9 / max(1LL, benchmark.resumes - config.battles);
+
+	// Merge Results
+	SimulationResult total;
+	for (const SimulationResult &result : shardResults)
+	{
+		total.merge(result);
+	}
+
+	return total;
 }
 // *******************************************
-//           printStats
-//    Displays all trainer information as well
-//		as information about their pokemon.
+//           scriptedBattleInput
+//    Answers whatever a battle waits for as
+//    simulatedAction() would play it, typed
+//    as menu numbers. Always has an answer.
 //********************************************
-void printStats(PlayerData &trainer)
+bool scriptedBattleInput(BattleSession &session)
 {
-	// Clear the Screen
-	clear();
-
-	// Draw 60 =
-	drawLines(60);
+	BattleInput &input = session.input;
 
-	// Print Trainer and Rival Name
-	cout << "Trainer Name: " << trainer.name << endl;
-	cout << "Rival's Name: " << trainer.rivalName << endl;
-	cout << endl;
-
-	// Print Money on Hand and Number of Pokemon
-	cout << "Money:   " << trainer.money << endl;
-	cout << "Pokemon: " << trainer.pokemonOwned << endl;
-	cout << endl;
+	if (input.waiting != INPUT_SELECTION)
+	{
+		input.value = 0;
+		return true;
+	}
 
-	// If the Trainer has Items, display them
-	if (trainer.hasItems())
+	// Plan the Next Action
+	if (session.scriptAt == session.scriptLength)
 	{
-		cout << "Bag: " << endl;
-		if (trainer.itemsOwned[ELIXIR] > 0)
+		BattleAction action = simulatedAction(session.battle);
+		session.scriptAt = 0;
+		session.scriptLength = 2;
+
+		if (session.battle.phase == PHASE_REPLACE)
 		{
-			cout << "Elixir   (Quantity: " << trainer.itemsOwned[ELIXIR] << ") " << endl;
+			session.script[0] = action.slot + 1;
+			session.scriptLength = 1;
 		}
-
-		if (trainer.itemsOwned[POKEBALL] > 0)
+		else
 		{
-			cout << "Pokeball (Quantity: " << trainer.itemsOwned[POKEBALL] << ") " << endl;
+			switch (action.type)
+			{
+			case ACTION_ATTACK:
+				session.script[0] = 1;
+				session.script[1] = (action.attackType == NORMAL) ? 1 : 2;
+				break;
+			case ACTION_ELIXIR:
+				session.script[0] = 2;
+				session.script[1] = 1;
+				break;
+			case ACTION_POKEBALL:
+				session.script[0] = 2;
+				session.script[1] = 2;
+				break;
+			case ACTION_SWAP:
+				session.script[0] = 3;
+				session.script[1] = action.slot + 1;
+				break;
+			case ACTION_FLEE:
+				session.script[0] = 4;
+				session.scriptLength = 1;
+				break;
+			}
 		}
-
-		cout << endl;
 	}
 
-	// Draw 60 =
-	drawLines(60);
+	input.value = session.script[session.scriptAt++];
+	return true;
+}
+// *******************************************
+//           switchBattle
+//    A battle coroutine that does nothing but
+//    wait, for timing a bare suspend/resume.
+//********************************************
+BattleTask switchBattle(BattleInput &input)
+{
+	while (true)
+	{
+		co_await input.enter();
+	}
+}
+// *******************************************
+//           measureCoroutineSwitch
+//    Nanoseconds for one resume of a battle
+//    coroutine and its suspend back.
+//********************************************
+double measureCoroutineSwitch(long long switches)
+{
+	BattleInput input;
+	BattleTask task = switchBattle(input);
 
-	// Pokemon Information
-	for (int i = 0; i < trainer.pokemonOwned; i++)
+	auto start = chrono::steady_clock::now();
+	for (long long i = 0; i < switches; i++)
 	{
-		// Get Current Pokemon for i
-		PokemonData currentPokemon = trainer.pokemon[i];
+		task.handle.resume();
+	}
 
-		// Are they Fainted or Ready to Battle?
-		string status = (currentPokemon.isDead == true ? "Fainted" : "Ready for Combat");
+	return chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / switches;
+}
+// *******************************************
+//           measureFiberSwitch
+//    The same round trip with the ucontext
+//    fibers the session server uses, for
+//    comparison (0 where there are none).
+//********************************************
+#ifdef HAVE_EPOLL
+ucontext_t switchCaller;
+ucontext_t switchFiber;
 
-		// Print Status
-		cout << "Name:  " << currentPokemon.name << endl;
-		cout << "Level: " << currentPokemon.level << endl;
-		cout << "EXP:   " << currentPokemon.exp << endl;
-		cout << "HP:    " << currentPokemon.health << " HP / " << currentPokemon.maxHealth << " HP" << endl;
-		cout << endl;
-		cout << "Status: " << status << endl;
-		cout << endl;
+double measureFiberSwitch(long long switches)
+{
+	vector<char> stack(64 * 1024);
 
-		// Print Icon
-		getPokemonIcon(currentPokemon.species);
+	getcontext(&switchFiber);
+	switchFiber.uc_stack.ss_sp = stack.data();
+	switchFiber.uc_stack.ss_size = stack.size();
+	switchFiber.uc_link = nullptr;
+	makecontext(&switchFiber, [] { while (true) swapcontext(&switchFiber, &switchCaller); }, 0);
 
-		// Draw 60 =
-		drawLines(60);
+	auto start = chrono::steady_clock::now();
+	for (long long i = 0; i < switches; i++)
+	{
+		swapcontext(&switchCaller, &switchFiber);
 	}
 
-	// Press Enter to Continue
-	pressEnterToContinue();
+	return chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / switches;
+}
+#else
+double measureFiberSwitch(long long switches)
+{
+	return 0;
 }
+#endif
 // *******************************************
-//           pokemonCenterCost
-//    Calculates how many credits it costs to
-//		bring a pokemon back to full health
-//    depending on what it's current health is.
+//           residentBytes
+//    Memory the process holds right now (0
+//    where it can't be read)
 //********************************************
-int pokemonCenterCost(int health, int maxHealth)
+size_t residentBytes()
 {
-	int healthToRestore = maxHealth - health;
+#if defined(__linux__)
+	ifstream statm("/proc/self/statm");
+	size_t pages = 0;
+	size_t resident = 0;
 
-	// 25 Credits per HP Restored
-	return healthToRestore * 25;
+	if (statm >> pages >> resident)
+	{
+		return resident * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+	}
+#endif
+	return 0;
 }
 // *******************************************
-//           pokemonCenterHeal
-//    Attempts to heal selected pokemon.
+//           simulateMode
+//    Command line entry point for:
+//    simulate [--battles N] [--species S]
+//             [--level L] [--pokeballs P]
+//             [--elixirs E] [--threads T]
+//             [--batch 1] [--coroutines 1]
+//             [--seed N] [--rng NAME]
+//             [--simd NAME]
 //********************************************
-Status pokemonCenterHeal(PlayerData &trainer, int pokemonToHeal)
+int simulateMode(int argc, char *argv[])
 {
-	// What Pokemon are we healing (modified to fit 0 based array.)
-	int pokemon = pokemonToHeal - 1;
+	SimulationConfig config;
+	config.seed = gameSeed;
+	int species = config.species;
 
-	// Get Pokemon Data for Pokemon Selected
-	PokemonData current = trainer.pokemon[pokemon];
+	// Read Options
+	for (int i = 2; i + 1 < argc; i += 2)
+	{
+		string option = argv[i];
+		string value = argv[i + 1];
 
-	// Determine how much it will cost
-	int cost = pokemonCenterCost(current.health, current.maxHealth);
+		if (option == "--battles")
+		{
+			config.battles = stoi(value);
+		}
+		else if (option == "--species")
+		{
+			// Accept either the Species Number or its Name (Checked before it is narrowed)
+			species = isdigit(value[0]) ? stoi(value) : 0;
+			for (int s = 0; s < POKEMON_IN_GAME; s++)
+			{
+				if (value == DefaultSpeciesNames[s])
+				{
+					species = s;
+				}
+			}
+		}
+		else if (option == "--level")
+		{
+			config.level = stoi(value);
+		}
+		else if (option == "--pokeballs")
+		{
+			config.pokeballs = stoi(value);
+		}
+		else if (option == "--elixirs")
+		{
+			config.elixirs = stoi(value);
+		}
+		else if (option == "--threads")
+		{
+			config.threads = stoi(value);
+		}
+		else if (option == "--batch")
+		{
+			config.batch = (value != "0");
+		}
+		else if (option == "--coroutines")
+		{
+			config.coroutines = (value != "0");
+		}
+	}
 
-	// Clear the Screen
-	clear();
+	if (config.battles <= 0 || config.level < 1 || config.level > POKEMON_MAX_LEVEL || species < 0 || species >= POKEMON_IN_GAME)
+	{
+		cout << "Usage: simulate [--battles N] [--species S] [--level L] [--pokeballs P] [--elixirs E] [--threads T] [--batch 1] [--coroutines 1]" << endl;
+		return 1;
+	}
 
-	// Display Pokemon Information
-	cout << "Pokemon Name: " << current.name << endl;
-	cout << "Current HP: " << current.health << " HP" << endl << endl;
+	config.species = static_cast<PokemonSpecies>(species);
 
-	// Display Menu to User to inquire about healing this Pokemon
-	cout << "Would you like to restore \"" << current.name << "\" to full health? (" << current.maxHealth << " HP)" << endl;
-	cout << "It will cost " << cost << " to restore them to full health." << endl << endl;
+	// Use Every Core unless told otherwise
+	config.threads = WorkStealingPool(config.threads).threadCount;
 
-	cout << "1. Accept" << endl;
-	cout << "2. Decline" << endl;
+	// Run Simulation
+	auto start = chrono::steady_clock::now();
+	CoroutineBenchmark benchmark;
+	SimulationResult result;
 
-	// Get User Selection
-	int selection = getMenuSelection();
+	if (config.batch)
+	{
+		result = simulateBatchBattles(config);
+	}
+	else if (config.coroutines)
+	{
+		result = simulateCoroutineBattles(config, benchmark);
+	}
+	else
+	{
+		result = simulateBattles(config);
+	}
 
-	// Clear the Screen
-	clear();
+	double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
 
-	if (selection == 1)
+	// Report
+	double battles = static_cast<double>(result.battles);
+
+	cout << fixed << setprecision(2);
+	cout << "Simulated " << result.battles << " battles (" << DefaultSpeciesNames[config.species] << " LV " << config.level << ") on " << config.threads << " threads in " << seconds * 1000 << " ms" << endl;
+	cout << "Seed: " << config.seed << endl;
+	if (config.batch)
 	{
-		// Attempt to Remove Money from Trainer's Wallet
-		Status removeMoney = trainer.removeMoney(cost);
+		cout << "Batch Kernel: " << damageKernelName(damageKernel) << " (attacks only, no items or swaps)" << endl;
+	}
+	if (config.coroutines)
+	{
+		// Bare Switch Cost (Timed on its own, after the battles)
+		benchmark.switches = 1000000;
+		benchmark.switchNanos = measureCoroutineSwitch(benchmark.switches);
+		benchmark.fiberSwitchNanos = measureFiberSwitch(benchmark.switches);
+
+		cout << "Coroutine Switch: " << benchmark.switchNanos << " ns per resume + suspend (ucontext fiber: " << benchmark.fiberSwitchNanos << " ns, "
+			<< benchmark.switches << " switches)" << endl;
+		cout << "Battles in Flight: " << benchmark.framesInFlight << ", " << benchmark.frameBytes << " byte frame + "
+			<< benchmark.sessionBytes << " byte session each, " << benchmark.residentBytes << " bytes resident each" << endl;
+		cout << "Battle Resumes: " << benchmark.resumes << ", " << benchmark.resumeNanos << " ns each (drawing and turns included)" << endl;
+		printMenuStatistics(benchmark.menuStatistics);
+		printLatencyStatistics(benchmark.latency);
+	}
+	cout << "Battles / sec: " << battles / seconds << endl << endl;
+	cout << "Win Rate:    " << 100.0 * result.wins / battles << "%" << endl;
+	cout << "Loss Rate:   " << 100.0 * result.losses / battles << "%" << endl;
+	cout << "Catch Rate:  " << 100.0 * result.caught / battles << "%" << endl;
+	cout << "Mean Turns:  " << result.turns / battles << endl;
+	cout << "Mean Money:  " << result.money / battles << endl;
+	cout << "Mean EXP:    " << result.exp / battles << endl;
 
-		// If SUCCESS then they had enough money
-		if (removeMoney == SUCCESS)
-		{
-			// Give 999 Health to Pokemon and set it to Alive (No Pokemon will have more than 999 health)
-			trainer.pokemon[pokemon].giveHealth(999);
-			trainer.pokemon[pokemon].isDead = false;
+	return 0;
+}
+// *******************************************
+//           benchMode
+//    Command line entry point for:
+//    bench [--repetitions N] [--warmup N]
+//          [--filter TEXT] [--output FILE]
+//          [--seed N] [--store PATH]
+//    Times every hot path of the game with a
+//    fixed seed and fixed operation counts,
+//    and writes the results as JSON (to the
+//    console unless --output is given), so
+//    runs can be compared build to build.
+//********************************************
+int benchMode(int argc, char *argv[])
+{
+	BenchmarkConfig config;
+	bool ownStore = (storePath == STORE_FILE);
 
-			// Print Success Message
-			cout << "Success! You have healed " << current.name << " to full health!" << endl;
+	// Read Options
+	for (int i = 2; i + 1 < argc; i += 2)
+	{
+		string option = argv[i];
+		string value = argv[i + 1];
+
+		if (option == "--repetitions")
+		{
+			config.repetitions = stoi(value);
 		}
-		else
+		else if (option == "--warmup")
 		{
-			// Player did not have enough money.
-			cout << "You do not have enough money to heal " << current.name << ". Come back when you have the money." << endl;
+			config.warmup = stoi(value);
+		}
+		else if (option == "--filter")
+		{
+			config.filter = value;
+		}
+		else if (option == "--output")
+		{
+			config.output = argv[i + 1];
+		}
+		else if (option == "--seed")
+		{
+			config.seed = gameSeed;
 		}
+	}
 
-		// Press Enter to Continue
-		pressEnterToContinue();
+	if (config.repetitions < 1 || config.warmup < 0)
+	{
+		cout << "Usage: bench [--repetitions N] [--warmup N] [--filter TEXT] [--output FILE] [--seed N] [--store PATH]" << endl;
+		return 1;
+	}
 
-		return SUCCESS;
+	// Saves go to a Store of their Own (unless --store names one)
+	string benchStore = storePath;
+	if (ownStore)
+	{
+		benchStore = (filesystem::temp_directory_path() / ("pokemon-bench-" + to_string(chrono::steady_clock::now().time_since_epoch().count()) + ".db")).string();
 	}
-	else
+
+	string error;
+	if (!storeOpen(trainerStore, benchStore.c_str(), error))
 	{
-		return FAILED;
+		cout << "Could not open " << benchStore << ": " << error << endl;
+		return 1;
 	}
-}
-// *******************************************
-//           pokemonCenter
-//    Displays the Pokemon Center Menu
-//********************************************
-void pokemonCenter(PlayerData &trainer)
-{
-	// Container for Selection
-	int selection = 0;
 
-	do
+	// Sprites (Frames are drawn with real sprites if pokemon.txt is around)
+	string spriteFile = benchmarkSpriteFile();
+	if (spriteAtlas.lines() == 0)
 	{
-		// Clear the Screen
-		clear();
+		spriteAtlas.load(spriteFile.c_str());
+	}
 
-		// Display Menu
-		cout << "Pokemon Center (Select Pokemon to Heal): " << endl << endl;
+	// Fixtures
+	SimulationConfig simulation;
+	simulation.seed = config.seed;
+	simulation.elixirs = 5;
+	simulation.pokeballs = 5;
 
-		// Create Menu Entry for each Pokemon in Trainer's Inventory
-		for (int i = 0; i < trainer.pokemonOwned; i++)
-		{
-			// Get Pokemon Data for i
-			PokemonData current = trainer.pokemon[i];
+	PlayerData trainer = simulationTrainer(simulation);
+	trainer.name = "Benchmark";
+	trainer.rivalName = "Rival";
+	for (int s = 1; s < PLAYER_MAX_POKEMON; s++)
+	{
+		PokemonData pokemon = trainer.pokemon[0];
+		pokemon.species = static_cast<PokemonSpecies>(s);
+		trainer.addPokemon(pokemon);
+	}
 
-			// Print Pokemon Data on Menu
-			cout << i + 1 << ". " << current.name << " ( " << current.health << " HP / " << current.maxHealth << " HP )" << endl;
-		}
+	PlayerData loaded;
+	PokemonData pokemon = trainer.pokemon[0];
+	BattleState battle = createWildBattle(trainer, RandomStream(config.seed, 0));
+	SpriteAtlas atlas;
 
-		// Spacing
-		cout << endl;
+	// Headless Terminal (Frames are built and diffed, then thrown away)
+	Terminal benchTerminal(nullptr);
+	benchTerminal.output.discard = true;
+	benchTerminal.battleScreen.console = false;
+
+	// Saves go through a one Entry Cache, so every load really reads the Store
+	trainerCache.resize(1);
+
+	vector<Benchmark> benchmarks =
+	{
+		{ "pokemon.takeDamage", "ns/op", 1000000, [&](long long operations)
+		{
+			long long sum = 0;
+			for (long long i = 0; i < operations; i++)
+			{
+				pokemon.health = 30;
+				pokemon.isDead = false;
+				sum += pokemon.takeDamage(static_cast<int>(i & 31));
+			}
+			benchmarkSink += sum;
+		} },
+		{ "pokemon.addExp", "ns/op", 1000000, [&](long long operations)
+		{
+			long long sum = 0;
+			for (long long i = 0; i < operations; i++)
+			{
+				if ((i & 1023) == 0)
+				{
+					pokemon.level = 5;
+					pokemon.exp = 0;
+				}
+				sum += pokemon.addExp(static_cast<int>(i & 63));
+			}
+			benchmarkSink += sum;
+		} },
+		{ "pokemon.giveHealth", "ns/op", 1000000, [&](long long operations)
+		{
+			long long sum = 0;
+			for (long long i = 0; i < operations; i++)
+			{
+				pokemon.health = static_cast<int>(i & 15);
+				pokemon.giveHealth(static_cast<int>(i & 31));
+				sum += pokemon.health;
+			}
+			benchmarkSink += sum;
+		} },
+		{ "save.encodeDecode", "ns/op", 20000, [&](long long operations)
+		{
+			string error;
+			for (long long i = 0; i < operations; i++)
+			{
+				trainer.money = static_cast<int>(i);
+				benchmarkSink += decodeSave(encodeSave(trainer), loaded, error);
+			}
+		} },
+		{ "save.roundTrip", "ns/op", 500, [&](long long operations)
+		{
+			string error;
+			StoreEntry entry;
+			for (long long i = 0; i < operations; i++)
+			{
+				// Save, Write Back, drop it from the Cache and Load it from the Store again
+				trainer.money = static_cast<int>(i);
+				trainer.pokemon[i % PLAYER_MAX_POKEMON].exp = static_cast<int>(i);
+				saveGame(trainer);
+				writeBackSave(trainer.name);
+				trainerCache.resize(1);
 
-		cout << "7. Return to Menu" << endl;
+				if (storeFind(trainerStore, trainer.name, entry))
+				{
+					benchmarkSink += loadGame(entry, loaded, error);
+				}
+			}
+		} },
+		{ "sprites.load", "ns/op", 2000, [&](long long operations)
+		{
+			for (long long i = 0; i < operations; i++)
+			{
+				atlas.load(spriteFile.c_str());
+				benchmarkSink += atlas.lines();
+			}
+		} },
+		{ "frame.battleMenu", "ns/frame", 20000, [&](long long operations)
+		{
+			for (long long i = 0; i < operations; i++)
+			{
+				drawBattleUI(trainer, battle.opponent, static_cast<MenuLocation>(i % MENU_LOCATIONS));
+				benchTerminal.output.present();
+			}
+			benchmarkSink += benchTerminal.output.frames;
+		} },
+		{ "frame.battleStatus", "ns/frame", 20000, [&](long long operations)
+		{
+			for (long long i = 0; i < operations; i++)
+			{
+				drawBattleUIStatus(battle.opponent, (i & 1) ? "Got away safely!" : "Can't Escape!");
+				benchTerminal.output.present();
+			}
+			benchmarkSink += benchTerminal.output.frames;
+		} },
+		{ "trace.span", "ns/span", 50000, [&](long long operations)
+		{
+			// Traced into the Ring (Emptied first, nothing is written to a file)
+			tracer.enabled = true;
+			benchTerminal.traceTrack = 1;
+			tracer.threadBuffer().discard();
+			for (long long i = 0; i < operations; i++)
+			{
+				TraceSpan span("bench", static_cast<int>(i));
+			}
+			benchTerminal.traceTrack = 0;
+			tracer.enabled = false;
+			benchmarkSink += tracer.threadBuffer().head.load();
+		} },
+		{ "trace.spanOff", "ns/span", 1000000, [&](long long operations)
+		{
+			for (long long i = 0; i < operations; i++)
+			{
+				TraceSpan span("bench", static_cast<int>(i));
+			}
+		} },
+		{ "message.format", "ns/op", 1000000, [&](long long operations)
+		{
+			char text[MESSAGE_TEXT_CAPACITY];
+			long long sum = 0;
+			for (long long i = 0; i < operations; i++)
+			{
+				Message message = makeMessage(WildHitMessage, battle.opponent.name(), MessageMove{ battle.opponent.species, static_cast<int>(i & 1) }, trainer.pokemon[0].name(), i & 31);
+				sum += message.format(text).size();
+			}
+			benchmarkSink += sum;
+		} },
+		{ "message.encodeDecode", "ns/op", 1000000, [&](long long operations)
+		{
+			uint8_t record[MESSAGE_BINARY_CAPACITY];
+			Message decoded;
+			long long sum = 0;
+			for (long long i = 0; i < operations; i++)
+			{
+				Message message = makeMessage(VictoryMessage, trainer.name, battle.opponent.name(), trainer.pokemon[0].name(), i, trainer.name, i * 3);
+				sum += decodeMessage(span<const uint8_t>(record, message.encode(record)), decoded);
+			}
+			benchmarkSink += sum;
+		} },
+		{ "battle.ui", "ns/battle", 2000, [&](long long operations)
+		{
+			// Whole Battles with every Frame drawn, Scripted Player answering (Text in the Arena)
+			benchmarkSink += playBenchmarkBattles(trainer, config.seed, operations);
+		} },
+		{ "battle.uiHeap", "ns/battle", 2000, [&](long long operations)
+		{
+			// The same with Battle Arenas off, so Battle Text goes to the Heap as before
+			battleArenas = false;
+			benchmarkSink += playBenchmarkBattles(trainer, config.seed, operations);
+			battleArenas = true;
+		} },
+		{ "battle.simulate", "ns/battle", 20000, [&](long long operations)
+		{
+			PlayerData fighter = simulationTrainer(simulation);
+			SimulationResult result;
+			for (long long i = 0; i < operations; i++)
+			{
+				simulateBattle(fighter, RandomStream(config.seed, i), result);
+			}
+			benchmarkSink += result.turns;
+		} }
+	};
 
-		// Get User Input
-		selection = getMenuSelection();
+	// Run (Frames are drawn on the Headless Terminal)
+	terminal = &benchTerminal;
+	screen.rdbuf(&benchTerminal.output);
 
-		// If the Selction is not 7 (return to menu) AND (Selection is Greater than ZERO AND Selection is less than or equal to pokemonOwned)
-		if (selection != 7 && (selection > 0 && selection <= trainer.pokemonOwned))
+	vector<BenchmarkResult> results;
+	for (const Benchmark &benchmark : benchmarks)
+	{
+		if (!config.filter.empty() && string(benchmark.name).find(config.filter) == string::npos)
 		{
-			// Send them to get Healed
-			pokemonCenterHeal(trainer, selection);
+			continue;
 		}
-	} while (selection != 7);
-}
-// *******************************************
-//           pokemonMartItem
-//    Attempts the purchase of an item from
-//    the Pokemon Mart.
-//********************************************
-Status pokemonMartItem(PlayerData &trainer, int item)
-{
-	// Clear the Screen
-	clear();
-
-	// Get Item Data for Selected Item (adjusts for zero based array)
-	PokemonItem selectedItem = itemData[item - 1];
-
-	// Print Item Information
-	cout << "Item Name:  " << selectedItem.name << endl;
-	cout << "Item Price: " << selectedItem.price << endl;
-	cout << "Item Description: " << selectedItem.description << endl;
-
-	// Spacing
-	cout << endl;
-
-	// Inquire about purchasing the item
-	cout << "Would you like to buy this item?" << endl;
-
-	// Spacing
-	cout << endl;
-
-	// Menu
-	cout << "1. Purchase" << endl;
-	cout << "2. Decline" << endl;
 
-	// Get User Input
-	int selection = getMenuSelection();
+		results.push_back(runBenchmark(benchmark, config));
+	}
 
-	// Clear the Screen
-	clear();
+	terminal = &consoleTerminal;
+	screen.rdbuf(&consoleTerminal.output);
 
-	if (selection == 1)
+	// Clean Up the Store and Sprites we made
+	error_code ignored;
+	trainerCache.resize(TRAINER_CACHE_CAPACITY);
+	if (ownStore)
 	{
-		// Attempt to add the item to Trainer's Inventory
-		Status addItem = trainer.addItem(static_cast<ItemNames>(item - 1));
+		filesystem::remove(benchStore, ignored);
+	}
+	if (spriteFile != "pokemon.txt")
+	{
+		filesystem::remove(spriteFile, ignored);
+	}
 
-		if (addItem == SUCCESS)
-		{
-			// Player had enough money
-			cout << "You have successfully purchased a " << selectedItem.name << "." << endl;
-		}
-		else
+	// Report
+	if (config.output != nullptr)
+	{
+		ofstream file(config.output, ios::out | ios::trunc);
+		if (!file)
 		{
-			// Player didn't have enough money
-			cout << "You do not have enough money to purchase a " << selectedItem.name << "." << endl;
+			cout << "Could not write " << config.output << endl;
+			return 1;
 		}
+
+		writeBenchmarkJson(file, config, results);
+		cout << "Wrote " << results.size() << " benchmarks to " << config.output << endl;
 	}
 	else
 	{
-		return FAILED;
+		writeBenchmarkJson(cout, config, results);
 	}
 
-	// Press Enter to Continue
-	pressEnterToContinue();
-
-	return SUCCESS;
+	return 0;
 }
 // *******************************************
-//           pokemonMart
-//    Displays the Pokemon Mart Menu
+//           runBenchmark
+//    Runs a benchmark warmup times untimed,
+//    then repetitions times timed, and keeps
+//    the nanoseconds per operation of each.
 //********************************************
-void pokemonMart(PlayerData &trainer)
+BenchmarkResult runBenchmark(const Benchmark &benchmark, const BenchmarkConfig &config)
 {
-	// Selection Container
-	int selection = 0;
+	BenchmarkResult result;
+	result.name = benchmark.name;
+	result.unit = benchmark.unit;
+	result.operations = benchmark.operations;
 
-	do
+	// Warm Up (Caches, branch predictors and the allocator)
+	for (int i = 0; i < config.warmup; i++)
 	{
-		// Clear the Screen
-		clear();
-
-		// Menu
-		cout << "Pokemon Mart (Select Item to Buy): " << endl;
-		cout << endl;
+		benchmark.run(benchmark.operations);
+	}
 
-		// Items
-		cout << "1. Elixir   (Cost: 500)" << endl;
-		cout << "2. Pokeball (Cost: 2000)" << endl;
-		cout << endl;
+	long long allocationsBefore = heapAllocations;
+	for (int i = 0; i < config.repetitions; i++)
+	{
+		auto start = chrono::steady_clock::now();
+		benchmark.run(benchmark.operations);
+		double nanos = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
 
-		cout << "3. Return to Menu" << endl;
+		result.samples.push_back(nanos / benchmark.operations);
+	}
 
-		// Get User Input
-		selection = getMenuSelection();
+	result.summarize();
+	result.allocations = static_cast<double>(heapAllocations - allocationsBefore) / max(1LL, config.repetitions * benchmark.operations);
 
-		// If (Selection is NOT 3 and (Selection is greater than ZERO AND Selection is less than or equal to the number of Items in Game))
-		if (selection != 3 && (selection > 0 && selection <= ITEMS_IN_GAME))
-		{
-			// Attempt to buy the item.
-			pokemonMartItem(trainer, selection);
-		}
-	} while (selection != 3);
+	return result;
 }
 // *******************************************
-//           drawBattleUIStatus
-//    Draws Battle UI with Health and Pokemon
-//		Image, but with a passthrough message
-// 		along with waiting for an enter key to
-//    be pressed.
+//           playBenchmarkBattles
+//    Plays whole wild battles on the current
+//    Terminal with the Scripted Player, each
+//    for a fresh copy of the trainer. Returns
+//    the turns played.
 //********************************************
-void drawBattleUIStatus(PlayerData &trainer, PokemonData &attackingPokemon, string text)
+long long playBenchmarkBattles(const PlayerData &trainer, uint64_t seed, long long battles)
 {
-	// Clear the Screen
-	clear();
+	long long turns = 0;
 
-	// Show Attacking Pokemon's Name, Level, and HP
-	drawBattleUIHeader(attackingPokemon);
+	BattleSession session;
+	for (long long i = 0; i < battles; i++)
+	{
+		session.trainer = trainer;
+		session.battle = createWildBattle(session.trainer, RandomStream(seed, i));
+		session.task = playBattle(session.battle, session.input);
+		session.scriptLength = 0;
+		session.scriptAt = 0;
 
-	// Draw Attacking Pokemon
-	getPokemonIcon(attackingPokemon.species);
+		while (true)
+		{
+			session.task.handle.resume();
+			terminal->output.bytes.clear();
 
-	// Draw 60 =
-	drawLines(60);
+			if (session.task.handle.done())
+			{
+				break;
+			}
 
-	// Output Message
-	cout << text << endl;
+			scriptedBattleInput(session);
+		}
 
-	// Draw 60 =
-	drawLines(60);
+		turns += session.battle.turns;
+	}
 
-	// Press Enter to Continue
-	pressEnterToContinue();
+	return turns;
 }
 // *******************************************
-//           computerAttack
-//    Processes Computer Attack
+//           writeBenchmarkJson
+//    Writes the results with a fixed layout
+//    and key order so files can be diffed.
 //********************************************
-Status computerAttack(PlayerData &trainer, PokemonData &attackingPokemon, Status &lastAttack)
+void writeBenchmarkJson(ostream &out, const BenchmarkConfig &config, const vector<BenchmarkResult> &results)
 {
-	// Variable
-	int attackUsed;
-	int attackToUse = rand() % 10;
-	int attackPower = 0;
-
-	// 10% Chance of Special Attack
-	if (attackToUse >= 8)
+	out << fixed << setprecision(2);
+	out << "{" << endl;
+	out << "  \"suite\": \"pokemon-bench\"," << endl;
+	out << "  \"version\": 1," << endl;
+	out << "  \"seed\": " << config.seed << "," << endl;
+	out << "  \"warmup\": " << config.warmup << "," << endl;
+	out << "  \"repetitions\": " << config.repetitions << "," << endl;
+	out << "  \"benchmarks\": [" << endl;
+
+	for (size_t i = 0; i < results.size(); i++)
 	{
-		// Special
-		attackUsed = 1;
+		const BenchmarkResult &result = results[i];
 
-		// Number between 0 and 9 * (level * .25)
-		attackPower = ((rand() % 9) * (attackingPokemon.level * 0.25));
-	}
-	else
-	{
-		// Normal
-		attackUsed = 0;
+		out << "    { \"name\": \"" << result.name << "\", \"unit\": \"" << result.unit << "\", \"operations\": " << result.operations
+			<< ", \"mean\": " << result.mean << ", \"stddev\": " << result.stddev
+			<< ", \"cv\": " << ((result.mean > 0) ? 100.0 * result.stddev / result.mean : 0.0)
+			<< ", \"min\": " << result.min << ", \"median\": " << result.median << ", \"max\": " << result.max
+			<< ", \"allocations\": ";
 
-		// Number between 0 and 5 + 3 * (level * .25);
-		attackPower = ((((rand() % 5) + 3)) * (attackingPokemon.level * 0.25));
-	}
+		// Allocations are only Counted in the Bench Build
+		if (COUNTING_ALLOCATIONS)
+		{
+			out << result.allocations;
+		}
+		else
+		{
+			out << "null";
+		}
 
-	// Hit Player
-	Status hitPokemon = trainer.pokemon[0].takeDamage(attackPower);
+		out << ", \"samples\": [";
+
+		for (size_t s = 0; s < result.samples.size(); s++)
+		{
+			out << ((s > 0) ? ", " : "") << result.samples[s];
+		}
 
-	// Create Status Message
-	vector <string> statusMessage = { "Wild ", attackingPokemon.name, " used ", speciesData[attackingPokemon.species].moveSet[attackUsed], "! " };
+		out << "] }" << ((i + 1 < results.size()) ? "," : "") << endl;
+	}
 
-	// Based on the result of hitting the player
-	switch (hitPokemon)
+	out << "  ]" << endl;
+	out << "}" << endl;
+}
+// *******************************************
+//           benchmarkSpriteFile
+//    pokemon.txt if it can be read, else a
+//    stand-in of the same shape (335 lines of
+//    40 columns) in the temp directory.
+//********************************************
+string benchmarkSpriteFile()
+{
+	if (ifstream("pokemon.txt"))
 	{
-	case HIT:
-		statusMessage.insert(statusMessage.end(), { trainer.pokemon[0].name, " took ", to_string(attackPower), " damage!" });
-		break;
-	case MISSED:
-		statusMessage.insert(statusMessage.end(), " It missed!");
-		break;
-	case DEAD:
-		statusMessage.insert(statusMessage.end(), { trainer.pokemon[0].name, " has fainted!" });
-		break;
+		return "pokemon.txt";
 	}
 
-	// Draw Status Message
-	drawBattleUIStatus(trainer, attackingPokemon, multipleStrings(statusMessage));
+	string path = (filesystem::temp_directory_path() / ("pokemon-bench-" + to_string(chrono::steady_clock::now().time_since_epoch().count()) + ".txt")).string();
 
-	// Set lastAttack
-	lastAttack = hitPokemon;
+	ofstream file(path, ios::out | ios::trunc);
+	for (int line = 0; line < speciesData[POKEMON_IN_GAME - 1].iconEnd; line++)
+	{
+		string row(40, ' ');
+		for (int column = line % 7; column < 40; column += 7)
+		{
+			row[column] = "/\\|_.-'"[(line + column) % 7];
+		}
+		file << row << '\n';
+	}
 
-	return SUCCESS;
+	return path;
 }
 // *******************************************
-//           playerAttack
-//    Processes Player Attack
+//           damageKernelScalar
+//    Applies one attack to every battle in a
+//    batch. Lanes where the attacker is out
+//    (skip) or the defender is already dead
+//    are left alone and report BATTLE_END.
+//    Damage is (roll * level) / 4, the same
+//    as roll * (level * 0.25) in the scalar
+//    battle core.
 //********************************************
-void playerAttack(PlayerData &trainer, PokemonData &attackingPokemon, Status &lastAttack)
+void damageKernelScalar(const int32_t *roll, const int32_t *level, const int32_t *skip, int32_t *health, int32_t *dead, int32_t *status, int count)
 {
-	// Show Battle UI Overview
-	drawBattleUI(trainer, attackingPokemon, OVERVIEW, lastAttack);
+	for (int i = 0; i < count; i++)
+	{
+		if (skip[i] != 0 || dead[i] != 0)
+		{
+			status[i] = BATTLE_END;
+			continue;
+		}
+
+		int32_t damage = (roll[i] * level[i]) >> 2;
+
+		if (damage == 0)
+		{
+			status[i] = MISSED;
+		}
+		else if (health[i] <= damage)
+		{
+			health[i] = 0;
+			dead[i] = 1;
+			status[i] = DEAD;
+		}
+		else
+		{
+			health[i] -= damage;
+			status[i] = HIT;
+		}
+	}
 }
+#ifdef BATTLE_SIMD
 // *******************************************
-//           swapPokemon
-//    Takes selected pokemon and moves it to
-//    the front of the Pokemon array for the
-//    trainer and moves the previously default
-//    pokemon to the place of the selected
-//    pokemon.
+//           damageKernelSSE42
+//    damageKernelScalar, 4 battles at a time.
+//    MISSED / DEAD / inactive lanes are
+//    handled with compare masks and blends
+//    instead of branches.
 //********************************************
-Status swapPokemon(PlayerData &trainer, int pokemonToSwap)
+BATTLE_TARGET("sse4.2")
+void damageKernelSSE42(const int32_t *roll, const int32_t *level, const int32_t *skip, int32_t *health, int32_t *dead, int32_t *status, int count)
 {
-	// Get Currently Equipped Pokemon Data
-	PokemonData currentPokemon = trainer.pokemon[0];
-
-	// Get Pokemon to be Swapped Data
-	PokemonData swapPokemon = trainer.pokemon[pokemonToSwap - 1];
-
-	// Create Summon Message
-	vector<string> message = { currentPokemon.name, " come back! Go! ", swapPokemon.name, "!" };
-
-	// If the Pokemon we are trying to swap to is not dead
-	if (swapPokemon.isDead != true)
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i one = _mm_set1_epi32(1);
+	const __m128i hit = _mm_set1_epi32(HIT);
+	const __m128i killed = _mm_set1_epi32(DEAD);
+	const __m128i missed = _mm_set1_epi32(MISSED);
+	const __m128i idle = _mm_set1_epi32(BATTLE_END);
+
+	int i = 0;
+	for (; i + 4 <= count; i += 4)
 	{
-		// Set the Zero Index (first Pokemon) to the Swap Pokemon
-		trainer.pokemon[0] = swapPokemon;
+		__m128i damage = _mm_srli_epi32(_mm_mullo_epi32(_mm_loadu_si128((const __m128i *)(roll + i)), _mm_loadu_si128((const __m128i *)(level + i))), 2);
+		__m128i hp = _mm_loadu_si128((const __m128i *)(health + i));
+		__m128i isDead = _mm_loadu_si128((const __m128i *)(dead + i));
 
-		// Set the Currently Equipped Pokemon to the Location of the Swap Pokemon
-		trainer.pokemon[pokemonToSwap - 1] = currentPokemon;
+		// Lanes that take part in this attack
+		__m128i active = _mm_and_si128(_mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *)(skip + i)), zero), _mm_cmpeq_epi32(isDead, zero));
 
-		// Draw Battle UI with Status Message
-		drawBattleUIStatus(trainer, swapPokemon, multipleStrings(message));
+		__m128i left = _mm_max_epi32(_mm_sub_epi32(hp, damage), zero);
+		__m128i miss = _mm_cmpeq_epi32(damage, zero);
+		__m128i kill = _mm_andnot_si128(miss, _mm_cmpeq_epi32(left, zero));
 
-		return SUCCESS;
-	}
-	else
-	{
-		// Draw Battle UI with Status Message
-		drawBattleUIStatus(trainer, swapPokemon, "This POKEMON is not fit for battle! Cannot swap!");
+		__m128i result = _mm_blendv_epi8(hit, killed, kill);
+		result = _mm_blendv_epi8(result, missed, miss);
+		result = _mm_blendv_epi8(idle, result, active);
 
-		return FAILED;
+		_mm_storeu_si128((__m128i *)(health + i), _mm_blendv_epi8(hp, left, active));
+		_mm_storeu_si128((__m128i *)(dead + i), _mm_or_si128(isDead, _mm_and_si128(_mm_and_si128(kill, active), one)));
+		_mm_storeu_si128((__m128i *)(status + i), result);
 	}
+
+	// Leftover Lanes
+	damageKernelScalar(roll + i, level + i, skip + i, health + i, dead + i, status + i, count - i);
 }
 // *******************************************
-//           deadPickNew
-//    Prompts user to select a new pokemon to
-//    replace the currently dead one. This
-//    message will only show up in the event
-//    that there are other pokemon in the
-//    trainer's inventory that aren't dead.
+//           damageKernelAVX2
+//    damageKernelScalar, 8 battles at a time.
 //********************************************
-void deadPickNew(PlayerData &trainer)
+BATTLE_TARGET("avx2")
+void damageKernelAVX2(const int32_t *roll, const int32_t *level, const int32_t *skip, int32_t *health, int32_t *dead, int32_t *status, int count)
 {
-	// Container for Status
-	Status swapSuccess;
-
-	do
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i one = _mm256_set1_epi32(1);
+	const __m256i hit = _mm256_set1_epi32(HIT);
+	const __m256i killed = _mm256_set1_epi32(DEAD);
+	const __m256i missed = _mm256_set1_epi32(MISSED);
+	const __m256i idle = _mm256_set1_epi32(BATTLE_END);
+
+	int i = 0;
+	for (; i + 8 <= count; i += 8)
 	{
-		// Clear the Screen
-		clear();
+		__m256i damage = _mm256_srli_epi32(_mm256_mullo_epi32(_mm256_loadu_si256((const __m256i *)(roll + i)), _mm256_loadu_si256((const __m256i *)(level + i))), 2);
+		__m256i hp = _mm256_loadu_si256((const __m256i *)(health + i));
+		__m256i isDead = _mm256_loadu_si256((const __m256i *)(dead + i));
 
-		// Tell User to pick new Pokemon
-		cout << "Call out a new POKEMON! " << endl;
+		// Lanes that take part in this attack
+		__m256i active = _mm256_and_si256(_mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i *)(skip + i)), zero), _mm256_cmpeq_epi32(isDead, zero));
 
-		// Print All Pokemon in Trainer's Inventory
-		for (int i = 0; i < trainer.pokemonOwned; i++)
-		{
-			// Only Print Pokemon that are not Dead
-			if (trainer.pokemon[i].isDead == false)
-			{
-				// Print Pokemon Stats
-				cout << i + 1 << ". " << left << setfill(' ') << setw(15) << trainer.pokemon[i].name;
-				cout << " LV: " << trainer.pokemon[i].level;
-				cout << " HP: " << trainer.pokemon[i].health;
-				cout << " HP / " << trainer.pokemon[i].maxHealth << " HP" << endl;
-			}
-		}
+		__m256i left = _mm256_max_epi32(_mm256_sub_epi32(hp, damage), zero);
+		__m256i miss = _mm256_cmpeq_epi32(damage, zero);
+		__m256i kill = _mm256_andnot_si256(miss, _mm256_cmpeq_epi32(left, zero));
 
-		// Get User Selection
-		int selection = getMenuSelection();
+		__m256i result = _mm256_blendv_epi8(hit, killed, kill);
+		result = _mm256_blendv_epi8(result, missed, miss);
+		result = _mm256_blendv_epi8(idle, result, active);
+
+		_mm256_storeu_si256((__m256i *)(health + i), _mm256_blendv_epi8(hp, left, active));
+		_mm256_storeu_si256((__m256i *)(dead + i), _mm256_or_si256(isDead, _mm256_and_si256(_mm256_and_si256(kill, active), one)));
+		_mm256_storeu_si256((__m256i *)(status + i), result);
+	}
 
-		// Swap the Pokemon
-		swapSuccess = swapPokemon(trainer, selection);
-	} while (swapSuccess == FAILED);
+	// Leftover Lanes
+	damageKernelScalar(roll + i, level + i, skip + i, health + i, dead + i, status + i, count - i);
 }
+#endif
 // *******************************************
-//           multipleStrings
-//    Takes a vector of strings and creates
-//    one string out of it.
+//           cpuSupports
+//    Checks if the CPU running the game has
+//    the given instruction set.
 //********************************************
-string multipleStrings(vector<string> statement)
+bool cpuSupports(const string &isa)
 {
-	// Creates Result Container
-	string result;
+#if defined(BATTLE_SIMD) && defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 1);
 
-	// For each item in the incoming vector
-	for (int i = 0; i < statement.size(); i++)
+	if (isa == "sse4.2")
 	{
-		// Append that Item to the Result String
-		result.append(statement.at(i));
+		return (info[2] & (1 << 20)) != 0;
 	}
 
-	// Return Result String
-	return result;
+	// AVX2 also needs the OS to save the YMM registers
+	bool osSavesYMM = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 6) == 6;
+	__cpuidex(info, 7, 0);
+
+	return isa == "avx2" && osSavesYMM && (info[1] & (1 << 5)) != 0;
+#elif defined(BATTLE_SIMD)
+	__builtin_cpu_init();
+
+	if (isa == "sse4.2")
+	{
+		return __builtin_cpu_supports("sse4.2");
+	}
+
+	return isa == "avx2" && __builtin_cpu_supports("avx2");
+#else
+	return false;
+#endif
 }
 // *******************************************
-//           playerWin
-//    Tells player they've won the battle and
-//    gives out money and experience.
+//           damageKernelByName
+//    Looks up a Damage Kernel by name. "best"
+//    picks the widest one this CPU can run.
+//    Returns nullptr if the CPU can't run it.
 //********************************************
-void playerWin(PlayerData &trainer, PokemonData &attackingPokemon)
+DamageKernel damageKernelByName(const string &name)
 {
-	// Determine how much EXP and Money to Give Player
-	int expEarned = attackingPokemon.level * 15;
-	int moneyEarned = attackingPokemon.level * 200;
-
-	// Create Victory Message
-	vector<string> messages = { trainer.name, " has defeated ", attackingPokemon.name, "! ",
-		trainer.pokemon[0].name, " has earned ", to_string(expEarned),
-		" EXP! \n", trainer.name, " has earned ", to_string(moneyEarned),
-		" credits!" };
-
-	// Add Money to Trainer's Wallet
-	trainer.money += moneyEarned;
+#ifdef BATTLE_SIMD
+	if ((name == "avx2" || name == "best") && cpuSupports("avx2"))
+	{
+		return damageKernelAVX2;
+	}
 
-	// Give EXP and check if the Pokemon Leveled Up
-	if (trainer.pokemon[0].addExp(expEarned) == LEVELUP)
+	if ((name == "sse4.2" || name == "best") && cpuSupports("sse4.2"))
 	{
-		// Create Level UP Message
-		vector<string> levelUP = { trainer.pokemon[0].name, " has leveled up to Level ", to_string(trainer.pokemon[0].level), "!" };
+		return damageKernelSSE42;
+	}
+#endif
 
-		// Display Battle UI with Status Message
-		drawBattleUIStatus(trainer, trainer.pokemon[0], multipleStrings(levelUP));
+	if (name == "scalar" || name == "best")
+	{
+		return damageKernelScalar;
 	}
 
-	// Display Battle UI with Status Message
-	drawBattleUIStatus(trainer, attackingPokemon, multipleStrings(messages));
+	return nullptr;
 }
 // *******************************************
-//           computerWin
-//    Calculates how much money the player has
-//    lost and tells them.
+//           damageKernelName
+//    Name of a Damage Kernel (for reports)
 //********************************************
-void computerWin(PlayerData &trainer, PokemonData &attackingPokemon)
+string damageKernelName(DamageKernel kernel)
 {
-	// Determine how much money will be taken from the Player
-	int moneyLost = attackingPokemon.level * 25;
-
-	// Create Loss Message
-	vector<string> messages = { trainer.name, " has been defeated by ", attackingPokemon.name, "! ",
-		trainer.name, " has lost ", to_string(moneyLost), " credits." };
+#ifdef BATTLE_SIMD
+	if (kernel == damageKernelAVX2)
+	{
+		return "avx2";
+	}
 
-	// Attempt to remove money from the Player
-	if (trainer.removeMoney(moneyLost) == FAILED)
+	if (kernel == damageKernelSSE42)
 	{
-		// The trainer doesn't have enough money to lose, so set it to zero.
-		trainer.money = 0;
+		return "sse4.2";
 	}
+#endif
 
-	// Draw Battle UI with Status Message
-	drawBattleUIStatus(trainer, attackingPokemon, multipleStrings(messages));
+	return "scalar";
 }
 // *******************************************
-//           mainBattleLoop
-//    Battle Loop for Pokemon Battle System
+//           rollBatchAttacks
+//    Fills the damage rolls for one attack in
+//    every battle of the batch. Normal attacks
+//    roll 3 - 7 and Special attacks 0 - 8.
+//    Computers use a Special 20% of the time.
 //********************************************
-void mainBattleLoop(PlayerData &trainer, PokemonData &attackingPokemon, int whoGoes)
+void rollBatchAttacks(BattleBatch &batch, vector<int32_t> &rolls, bool isComputer)
 {
-	// Are We Battling?
-	bool isBattling = true;
+	// Two Draws per Battle (Attack Type and Power)
+	batch.random.fill(batch.draws.data(), batch.count * 2);
 
-	// Status Variable
-	Status lastAttack;
+	const uint32_t *type = batch.draws.data();
+	const uint32_t *power = batch.draws.data() + batch.count;
 
-	// Determine Loop Order
-	if (whoGoes == 0)
+	for (int i = 0; i < batch.count; i++)
 	{
-		// Computer Goes First
-		while (isBattling)
-		{
-			// Computer Attacks
-			computerAttack(trainer, attackingPokemon, lastAttack);
-
-			// If the Computer killed the trainer's current Pokemon
-			if (lastAttack == DEAD)
-			{
-				// Do we have any replacement pokemon?
-				if (trainer.alivePokemon() != 0)
-				{
-					// Tell Trainer to Pick a New One
-					deadPickNew(trainer);
-				}
-				else
-				{
-					// Computer Win
-					computerWin(trainer, attackingPokemon);
+		bool special = isComputer && ((static_cast<uint64_t>(type[i]) * 10) >> 32) >= 8;
 
-					// End Battle
-					isBattling = false;
-					break;
-				}
-			}
-
-			// Player Attacks
-			playerAttack(trainer, attackingPokemon, lastAttack);
-
-			// If the Player kills the Computer
-			if (lastAttack == DEAD)
-			{
-				// Player Win
-				playerWin(trainer, attackingPokemon);
-
-				// End Battle
-				isBattling = false;
-				break;
-			}
-			// If Player Ended Battle (Fled / Pokeball)
-			else if (lastAttack == BATTLE_END)
-			{
-				// End Battle
-				isBattling = false;
-				break;
-			}
-		}
+		rolls[i] = special
+			? static_cast<int32_t>((static_cast<uint64_t>(power[i]) * 9) >> 32)
+			: static_cast<int32_t>((static_cast<uint64_t>(power[i]) * 5) >> 32) + 3;
 	}
-	else
+}
+// *******************************************
+//           initBattleBatch
+//    Sets up count one-on-one battles between
+//    copies of the given pokemon and wild
+//    opponents rolled like createWildBattle,
+//    including the Computer's opening attack
+//    in the battles where it goes first.
+//********************************************
+void initBattleBatch(BattleBatch &batch, const PokemonData &pokemon, int count, RandomStream random)
+{
+	batch.count = count;
+	batch.running = count;
+	batch.random = random;
+
+	batch.playerHealth.assign(count, pokemon.health);
+	batch.playerLevel.assign(count, pokemon.level);
+	batch.playerDead.assign(count, 0);
+	batch.opponentHealth.resize(count);
+	batch.opponentLevel.resize(count);
+	batch.opponentDead.assign(count, 0);
+	batch.turns.assign(count, 0);
+
+	batch.draws.resize(count * 2);
+	batch.playerRoll.resize(count);
+	batch.computerRoll.resize(count);
+	batch.status.resize(count);
+	batch.skip.resize(count);
+
+	// Roll Opponents (Level is within -3 / +3 of the Player's, and at least 1)
+	batch.random.fill(batch.draws.data(), count * 2);
+
+	for (int i = 0; i < count; i++)
 	{
-		// Player Goes First
-		while (isBattling)
-		{
-			// Player Attack
-			playerAttack(trainer, attackingPokemon, lastAttack);
+		int level = static_cast<int>((static_cast<uint64_t>(batch.draws[i]) * 7) >> 32) + pokemon.level - 3;
+		level = max(level, 1);
 
-			// If Player killed Computer
-			if (lastAttack == DEAD)
-			{
-				// Player Win
-				playerWin(trainer, attackingPokemon);
+		batch.opponentLevel[i] = level;
+		batch.opponentHealth[i] = level * 5;
 
-				// End Battle
-				isBattling = false;
-				break;
-			}
-			// If Player Ended Battle (Fled / Pokeball)
-			else if (lastAttack == BATTLE_END)
-			{
-				// End Battle
-				isBattling = false;
-				break;
-			}
+		// Opponents that won the coin toss get an attack in before the first turn
+		batch.skip[i] = (batch.draws[count + i] >> 31);
+	}
 
-			// Computer Attack
-			computerAttack(trainer, attackingPokemon, lastAttack);
+	rollBatchAttacks(batch, batch.computerRoll, true);
+	damageKernel(batch.computerRoll.data(), batch.opponentLevel.data(), batch.skip.data(), batch.playerHealth.data(), batch.playerDead.data(), batch.status.data(), count);
 
-			// If Computer killed Player
-			if (lastAttack == DEAD)
-			{
-				// Do they have other pokemon?
-				if (trainer.alivePokemon() != 0)
-				{
-					// Tell Them to Swap
-					deadPickNew(trainer);
-					continue;
-				}
-				else
-				{
-					// Computer Win
-					computerWin(trainer, attackingPokemon);
+	batch.running = 0;
+	for (int i = 0; i < count; i++)
+	{
+		batch.running += (batch.playerDead[i] == 0);
+	}
+}
+// *******************************************
+//           resolveBatchTurn
+//    Resolves one turn (Player attack, then
+//    Computer attack) for every battle in the
+//    batch that is still running. Returns the
+//    number of battles still running.
+//********************************************
+int resolveBatchTurn(BattleBatch &batch)
+{
+	int count = batch.count;
+
+	// Count the Turn for Battles still Running
+	for (int i = 0; i < count; i++)
+	{
+		batch.turns[i] += (batch.playerDead[i] | batch.opponentDead[i]) == 0;
+	}
 
-					// End Battle
-					isBattling = false;
-					break;
-				}
-			}
-		}
+	rollBatchAttacks(batch, batch.playerRoll, false);
+	rollBatchAttacks(batch, batch.computerRoll, true);
+
+	// Player Attacks, then any Opponent still Standing Attacks Back
+	damageKernel(batch.playerRoll.data(), batch.playerLevel.data(), batch.playerDead.data(), batch.opponentHealth.data(), batch.opponentDead.data(), batch.status.data(), count);
+	damageKernel(batch.computerRoll.data(), batch.opponentLevel.data(), batch.opponentDead.data(), batch.playerHealth.data(), batch.playerDead.data(), batch.status.data(), count);
+
+	batch.running = 0;
+	for (int i = 0; i < count; i++)
+	{
+		batch.running += (batch.playerDead[i] | batch.opponentDead[i]) == 0;
 	}
+
+	return batch.running;
 }
 // *******************************************
-//           pokemonBattleSetup
-//    Creates Opponent for the Pokemon Battle
+//           simulateBatchBattles
+//    Plays config.battles one-on-one battles
+//    (attacks only, no items or swaps) as
+//    batches through the damage kernel. Each
+//    pool task runs one batch.
 //********************************************
-void pokemonBattleSetup(PlayerData &trainer)
+SimulationResult simulateBatchBattles(const SimulationConfig &config)
 {
-	// Clear Screen
-	clear();
+	// Battles per Batch (Big enough to keep the kernel busy, small enough to stay in cache)
+	const int BATTLES_PER_BATCH = 4096;
 
-	// Get Data about Primary Pokemon in Trainer's Possession
-	PokemonData trainerPrimary = trainer.pokemon[0];
+	PokemonData pokemon;
+	pokemon.level = config.level;
+	pokemon.health = config.level * 5;
 
-	// Get Random Species 0 - 9
-	int opponentSpecies = rand() % 10;
+	WorkStealingPool pool(config.threads);
+	int tasks = (config.battles + BATTLES_PER_BATCH - 1) / BATTLES_PER_BATCH;
 
-	// Determine the Highest and Lowest Levels possible
-	int lowestLevel = trainerPrimary.level - 3;
-	int highestLevel = trainerPrimary.level + 4;
+	vector<SimulationResult> workerResults(pool.threadCount);
 
-	// Generate Level
-	int opponentLevel = (rand() % (highestLevel - lowestLevel)) + lowestLevel;
+	pool.run(tasks, [&](int worker, int task)
+	{
+		int count = min(BATTLES_PER_BATCH, config.battles - task * BATTLES_PER_BATCH);
 
-	// Make sure level isn't less than 1
-	if (opponentLevel < 1) opponentLevel = 1;
+		BattleBatch batch;
+		initBattleBatch(batch, pokemon, count, RandomStream(config.seed, task));
 
-	// Create Opponent
-	PokemonData attackingPokemon;
-	attackingPokemon.name = DefaultSpeciesNames[opponentSpecies];
-	attackingPokemon.level = opponentLevel;
-	attackingPokemon.health = opponentLevel * 5;
-	attackingPokemon.maxHealth = attackingPokemon.health;
-	attackingPokemon.species = static_cast<PokemonSpecies>(opponentSpecies);
+		while (resolveBatchTurn(batch) > 0)
+		{
+		}
 
-	// Determine Who Attacks First
-	int whoGoes = rand() % 2;
+		// Tally Outcomes (Same rewards as playerWin / computerWin with the default 5000 credits)
+		SimulationResult &result = workerResults[worker];
+		for (int i = 0; i < count; i++)
+		{
+			int level = batch.opponentLevel[i];
 
-	// Create Status Message (A wild POKEMON_NAME appeared! GO! PRIMARY_NAME!)
-	vector<string> statusMessage = { "A wild ", attackingPokemon.name, " appeared! GO! ", trainerPrimary.name, "!" };
+			result.battles++;
+			result.turns += batch.turns[i];
 
-	// Draw UI
-	drawBattleUIStatus(trainer, attackingPokemon, multipleStrings(statusMessage));
+			if (batch.opponentDead[i] != 0)
+			{
+				result.wins++;
+				result.exp += level * 15;
+				result.money += level * 200;
+			}
+			else
+			{
+				result.losses++;
+				result.money -= min(5000, level * 25);
+			}
+		}
+	});
 
-	// Begin Loop
-	mainBattleLoop(trainer, attackingPokemon, whoGoes);
+	SimulationResult total;
+	for (int i = 0; i < pool.threadCount; i++)
+	{
+		total.merge(workerResults[i]);
+	}
+
+	return total;
 }
 // *******************************************
 //           mainGameLoop
@@ -1652,9 +9197,9 @@ void mainGameLoop(PlayerData &trainer)
 		clear();
 
 		// Print Menu
-		cout << "===================================================================" << endl;
-		cout << "== 1. Battle == 2. Shop == 3. Heal == 4. Stats == 5. Save / Quit ==" << endl;
-		cout << "===================================================================" << endl;
+		screen << "===================================================================" << endl;
+		screen << "== 1. Battle == 2. Shop == 3. Heal == 4. Stats == 5. Save / Quit ==" << endl;
+		screen << "===================================================================" << endl;
 
 		// Get Input
 		input = getMenuSelection();
@@ -1668,7 +9213,7 @@ void mainGameLoop(PlayerData &trainer)
 				pokemonBattleSetup(trainer);
 
 				// After Battle, Auto Save Game
-				saveGame(trainer);
+				saveWorker.request(trainer);
 			}
 			else
 			{
@@ -1676,7 +9221,7 @@ void mainGameLoop(PlayerData &trainer)
 				clear();
 
 				// Tell User they have no Pokemon fit for Battle
-				cout << "None of your Pokemon are fit for battle. You need to heal one before you can fight again." << endl;
+				screen << "None of your Pokemon are fit for battle. You need to heal one before you can fight again." << endl;
 
 				// Press Enter to Continue
 				pressEnterToContinue();
@@ -1687,22 +9232,23 @@ void mainGameLoop(PlayerData &trainer)
 			pokemonMart(trainer);
 
 			// Auto Save Game
-			saveGame(trainer);
+			saveWorker.request(trainer);
 			break;
 		case 3:
 			// Go to Pokemon Center
 			pokemonCenter(trainer);
 
 			// Auto Save Game
-			saveGame(trainer);
+			saveWorker.request(trainer);
 			break;
 		case 4:
 			// Display Trainer Info
 			printStats(trainer);
 			break;
 		case 5:
-			// Save Game
-			saveGame(trainer);
+			// Save Game (Wait until it is on Disk)
+			saveWorker.request(trainer);
+			saveWorker.flush(trainer.name);
 
 			// Stop Playing
 			playing = false;
@@ -1716,320 +9262,482 @@ void mainGameLoop(PlayerData &trainer)
 //********************************************
 void mainMenu(PlayerData &trainer)
 {
-	// Clear the Screen
-	clear();
+	// Shown Again (not called again) when the User backs out of a Menu
+	while (true)
+	{
+		// Clear the Screen
+		clear();
 
-	// Display the Menu
-	cout << "Pokemon - Main Menu" << endl;
+		// Display the Menu
+		screen << "Pokemon - Main Menu" << endl;
 
-	// If there is a Save File
-	if (gameExists())
-	{
-		cout << "1. Continue Game" << endl;
-	}
+		// If there is a Save File
+		if (gameExists())
+		{
+			screen << "1. Continue Game" << endl;
+		}
 
-	cout << "2. New Game" << endl;
-	cout << "3. Exit Game" << endl;
+		screen << "2. New Game" << endl;
+		screen << "3. Exit Game" << endl;
 
-	// Get Menu Selection
-	int menuSelection = getMenuSelection();
+		// Get Menu Selection
+		int menuSelection = getMenuSelection();
 
-	// Ignore the Enter
-	cin.ignore();
+		// Ignore the Enter
+		terminal->input.ignore();
 
-	switch (menuSelection)
-	{
-	case 1:
-		// If there isn't a Save File (Quit)
-		if (!gameExists())
+		switch (menuSelection)
 		{
-			clear();
-			cout << "No Game to Load. You shouldn't be here. Exiting." << endl;
-			exit(0);
-		}
+		case 1:
+			// If there isn't a Save File (Quit)
+			if (!gameExists())
+			{
+				clear();
+				screen << "No Game to Load. You shouldn't be here. Exiting." << endl;
+				return;
+			}
 
-		// Load Save File
-		loadGame(trainer);
+			// Pick and Load a Trainer
+			{
+				StoreEntry entry;
 
-		// Enter Main Game Loop
-		mainGameLoop(trainer);
-		break;
-	case 2:
-		// Create New Trainer
-		newGame(trainer);
+				if (selectSavedTrainer(entry) == FAILED)
+				{
+					// Back to the Main Menu
+					continue;
+				}
 
-		// Save Game
-		saveGame(trainer);
+				string error;
 
-		// Enter Main Game Loop
-		mainGameLoop(trainer);
-		break;
-	case 3:
-		// Exit
-		exit(0);
-		break;
+				if (loadGame(entry, trainer, error) == FAILED)
+				{
+					clear();
+					screen << "Save File could not be loaded (" << error << "). Exiting." << endl;
+					return;
+				}
+			}
+
+			// Enter Main Game Loop
+			mainGameLoop(trainer);
+			return;
+		case 2:
+			// Create New Trainer
+			newGame(trainer);
+
+			// Save Game
+			saveWorker.request(trainer);
+
+			// Enter Main Game Loop
+			mainGameLoop(trainer);
+			return;
+		case 3:
+			// Exit
+			return;
+		}
+
+		// Any other Selection Exits, as it always has
+		return;
 	}
 }
 // *******************************************
-//           battleUIAttack
-//    Attacks opponent. This is invoked by the
-//		user's battle UI.
+//           selectSavedTrainer
+//    Lists the saved Trainers a page at a
+//    time and lets the User pick one, or
+//    look one up by name. Returns FAILED if
+//    the User goes back.
 //********************************************
-void battleUIAttack(PlayerData &trainer, PokemonData &attackingPokemon, Status attackType, Status &battleStatus)
+Status selectSavedTrainer(StoreEntry &entry)
 {
-	// Containers for Attack Power and Attack Used
-	int attackPower;
-	int attackUsed;
+	// Constant Values
+	const int TRAINERS_PER_PAGE = 8;
 
-	if (attackType == NORMAL)
-	{
-		// Normal Attack
-		attackUsed = 0;
+	uint32_t from = 0;
+	string notice;
+	vector<StoreEntry> entries;
 
-		// Number between 0 and 5 + 3 * (level * .25)
-		attackPower = ((((rand() % 5) + 3)) * (trainer.pokemon[0].level * 0.25));
-	}
-	else
+	while (true)
 	{
-		// Special Attack
-		attackUsed = 1;
+		// Read One Page of the Index
+		entries.clear();
+		uint32_t next = storeList(trainerStore, from, TRAINERS_PER_PAGE, entries);
 
-		// Number between 0 and 9 * (level * .25)
-		attackPower = ((rand() % 9) * (trainer.pokemon[0].level * 0.25));
-	}
+		// Clear the Screen
+		clear();
 
-	// Hit Attacking Pokemon
-	Status doDamage = attackingPokemon.takeDamage(attackPower);
+		// Display the Trainers
+		screen << "Pokemon - Continue Game" << endl;
 
-	// Create Use Message
-	vector<string> statusMessage = { trainer.pokemon[0].name, " used ", speciesData[trainer.pokemon[0].species].moveSet[attackUsed], "! " };
+		if (!notice.empty())
+		{
+			screen << notice << endl;
+			notice.clear();
+		}
 
-	switch (doDamage)
-	{
-	case HIT:
-		// Create Hit Message
-		statusMessage.insert(statusMessage.end(), { "Wild ", attackingPokemon.name, " took ", to_string(attackPower), " damage!" });
-		break;
-	case MISSED:
-		// Create Miss Message
-		statusMessage.insert(statusMessage.end(), " It missed!");
-		break;
-	case DEAD:
-		// Create Dead Message
-		statusMessage.insert(statusMessage.end(), { "Wild ", attackingPokemon.name, " has fainted!" });
-		break;
-	}
+		screen << endl;
+
+		for (int i = 0; i < static_cast<int>(entries.size()); i++)
+		{
+			screen << i + 1 << ". " << entries[i].name << (entries[i].partialName ? "..." : "") << endl;
+		}
+
+		screen << endl;
+		screen << "9. " << ((next != 0) ? "Next Page" : "First Page") << endl;
+		screen << "10. Find by Name" << endl;
+		screen << "11. Back" << endl;
+
+		// Get Menu Selection
+		int selection = getMenuSelection();
+
+		// Ignore the Enter
+		terminal->input.ignore();
+
+		if (selection >= 1 && selection <= static_cast<int>(entries.size()))
+		{
+			entry = entries[selection - 1];
+			return SUCCESS;
+		}
+
+		switch (selection)
+		{
+		case 9:
+			from = next;
+			break;
+		case 10:
+		{
+			// Look Up the Name in the Index
+			string name;
+			screen << "Enter the trainer's name: ";
+			terminal->output.present();
+			getline(terminal->input, name);
 
-	// Set battleStatus to doDamage (for other systems)
-	battleStatus = doDamage;
+			if (storeFind(trainerStore, name, entry))
+			{
+				return SUCCESS;
+			}
 
-	// Draw Battle UI with Status Message
-	drawBattleUIStatus(trainer, attackingPokemon, multipleStrings(statusMessage));
+			notice = "No trainer called " + name + ".";
+			break;
+		}
+		case 11:
+			return FAILED;
+		}
+	}
 }
 // *******************************************
-//           battleUIFlee
-//    Attempts to flee from battle. This is
-//		invoked by the user's battle UI.
+//           battleUIController
+//    Controller for the Battle UI System.
+//    Based on where the User is in the UI
+//		this function moves them to a new
+//		location or fills in the action they
+//		picked for the Battle Core. Returns
+//		true once an action is picked.
 //********************************************
-void battleUIFlee(PlayerData &trainer, PokemonData &attackingPokemon, Status &battleStatus)
+bool battleUIController(MenuLocation &location, int menuSelection, BattleAction &action)
 {
-	// 50/50 Chance of Success
-	int chance = rand() % 2;
+	// Look up the Transition
+	int column = (menuSelection >= 0 && menuSelection < MENU_SELECTIONS) ? menuSelection : MENU_SELECTIONS;
+	const MenuTransition &transition = BATTLE_MENU[location][column];
 
-	if (chance == 0)
+	if (!transition.picks)
 	{
-		// Fled
-		drawBattleUIStatus(trainer, attackingPokemon, "Got away safely!");
-		battleStatus = BATTLE_END;
+		location = transition.next;
+		return false;
 	}
-	else
+
+	// Fill in the Picked Action
+	action.type = transition.type;
+	action.attackType = transition.attackType;
+	if (transition.type == ACTION_SWAP)
 	{
-		// Failed
-		drawBattleUIStatus(trainer, attackingPokemon, "Can't Escape!");
-		battleStatus = BATTLE_CONTINUE;
+		action.slot = menuSelection - 1;
 	}
+
+	return true;
 }
 // *******************************************
-//           throwPokeball
-//    Attempts to throw a pokeball and catch
-//    the opponent. This is invoked by the
-//		user's battle UI.
+//           printMenuStatistics
+//    Lists every battle menu transition that
+//    happened, how often, and what drawing
+//    the menu and moving on cost on average.
 //********************************************
-Status throwPokeball(PlayerData &trainer, PokemonData &attackingPokemon, Status &battleStatus)
+void printMenuStatistics(const BattleMenuStatistics &statistics)
 {
-	// 1 / 10 (10% Chance)
-	int chance = rand() % 10;
+	const char *names[MENU_LOCATIONS + 1] = { "Attack", "Bag", "Pokemon", "Overview", "picked" };
 
-	if (chance == 0)
-	{
-		// Attempt to Catch Pokemon
-		Status addAttempt = trainer.addPokemon(attackingPokemon);
+	cout << "Battle menu transitions:" << endl;
 
-		if (addAttempt == SUCCESS)
+	for (int from = 0; from < MENU_LOCATIONS; from++)
+	{
+		for (int to = 0; to <= MENU_LOCATIONS; to++)
 		{
-			// End Battle
-			battleStatus = BATTLE_END;
+			long long count = statistics.transitions[from][to];
 
-			return CAUGHT;
-		}
-		else
-		{
-			battleStatus = BATTLE_CONTINUE;
-			return FAILED;
+			if (count == 0)
+			{
+				continue;
+			}
+
+			cout << "  " << left << setfill(' ') << setw(9) << names[from] << "-> " << setw(9) << names[to] << right
+				<< setw(10) << count << " x " << setw(7) << statistics.nanos[from][to] / count << " ns" << endl;
 		}
 	}
-	else
-	{
-		battleStatus = BATTLE_CONTINUE;
-		return FAILED;
-	}
 }
+#ifdef POKEMON_PROFILE
 // *******************************************
-//           battleUIController
-//    Controller for the Battle UI System.
-//    Based on where the User is in the UI
-//		this function redirects them to a new
-//		location.
+//           initProfiler
+//    Dumps the profile to stderr when the
+//    game exits, and whenever the process
+//    gets SIGUSR1 (kill -USR1 PID) so a live
+//    session can be looked at. SIGUSR1 is
+//    blocked in every thread and taken by a
+//    thread of its own with sigwait, so the
+//    dump never runs inside a handler.
 //********************************************
-void battleUIController(PlayerData &trainer, PokemonData &attackingPokemon, MenuLocation &location, int menuSelection, Status &battleStatus)
+void initProfiler()
 {
-	// Containers for Message and Catch Attempt
-	string message;
-	Status catchAttempt;
+	atexit(printProfileAtExit);
+
+#ifdef HAVE_POSIX
+	// Threads Started Later Inherit the Mask
+	sigset_t signals;
+	sigemptyset(&signals);
+	sigaddset(&signals, SIGUSR1);
+	pthread_sigmask(SIG_BLOCK, &signals, nullptr);
 
-	switch (location)
+	thread([signals]()
 	{
-	case OVERVIEW:
-		switch (menuSelection)
+		while (true)
 		{
-		case 1:
-			drawBattleUI(trainer, attackingPokemon, ATTACK, battleStatus);
-			break;
-		case 2:
-			drawBattleUI(trainer, attackingPokemon, BAG, battleStatus);
-			break;
-		case 3:
-			drawBattleUI(trainer, attackingPokemon, SELECTION, battleStatus);
-			break;
-		case 4:
-			battleUIFlee(trainer, attackingPokemon, battleStatus);
-			break;
+			int received = 0;
+			if (sigwait(&signals, &received) == 0 && received == SIGUSR1)
+			{
+				printProfile(cerr);
+			}
 		}
-		break;
-	case ATTACK:
-		switch (menuSelection)
+	}).detach();
+#endif
+}
+// *******************************************
+//           printProfile
+//    Adds up every thread's counters and
+//    lists calls, total time and the p50 and
+//    p99 of each profile point.
+//********************************************
+void printProfile(ostream &out)
+{
+	unique_ptr<ProfileTotals> totals = make_unique<ProfileTotals>();
+
+	{
+		lock_guard<mutex> guard(profiler.lock);
+
+		*totals = *profiler.retired;
+		for (ProfileThread *thread : profiler.threads)
 		{
-		case 1:
-			battleUIAttack(trainer, attackingPokemon, NORMAL, battleStatus);
-			break;
-		case 2:
-			battleUIAttack(trainer, attackingPokemon, SPECIAL, battleStatus);
-			break;
-		case 3:
-			drawBattleUI(trainer, attackingPokemon, OVERVIEW, battleStatus);
-			break;
+			totals->add(*thread);
 		}
-		break;
-	case BAG:
-		switch (menuSelection)
-		{
-		case 1:
-			if (trainer.removeItem(ELIXIR) != FAILED)
-			{
-				// Give Current Pokemon 20 HP
-				trainer.pokemon[0].giveHealth(20);
+		totals->threads = profiler.retiredThreads + static_cast<int>(profiler.threads.size());
+	}
 
-				// Create Message
-				vector<string> message = { "Added 20 HP to ", trainer.pokemon[0].name, "!" };
+	ostringstream table;
+	table << fixed << setprecision(2);
+	table << "Profile (" << totals->threads << " threads):" << endl;
+	table << "  " << left << setw(20) << "point" << right << setw(12) << "calls" << setw(14) << "total ms"
+		<< setw(12) << "p50 us" << setw(12) << "p99 us" << endl;
 
-				// Draw Battle UI with Message
-				drawBattleUIStatus(trainer, attackingPokemon, multipleStrings(message));
-			}
-			else
-			{
-				// Player doesn't have any Elixir
-				drawBattleUIStatus(trainer, attackingPokemon, "You do not have any of that item.");
-			}
+	for (int p = 0; p < PROFILE_POINTS; p++)
+	{
+		if (totals->calls[p] == 0)
+		{
+			continue;
+		}
 
-			battleStatus = BATTLE_CONTINUE;
+		table << "  " << left << setw(20) << ProfilePointNames[p] << right << setw(12) << totals->calls[p]
+			<< setw(14) << totals->nanos[p] / 1e6 << setw(12) << totals->percentile(p, 0.50) / 1e3
+			<< setw(12) << totals->percentile(p, 0.99) / 1e3 << endl;
+	}
 
-			break;
-		case 2:
-			if (trainer.removeItem(POKEBALL) != FAILED)
-			{
-				// Create Message
-				vector<string> message = { trainer.name, " used a POKEBALL! " };
+	// One Write, so it isn't Interleaved with other Output
+	string text = table.str();
+	out.write(text.data(), text.size());
+	out.flush();
+}
+// *******************************************
+//           printProfileAtExit
+//    atexit hook for printProfile
+//********************************************
+void printProfileAtExit()
+{
+	printProfile(cerr);
+}
+#endif
+// *******************************************
+//           parseLatencyObjective
+//    Reads METRIC:PERCENTILE:MICROSECONDS,
+//    e.g. input-to-frame:99.99:2000
+//********************************************
+bool parseLatencyObjective(const string &text, LatencyObjective &objective)
+{
+	size_t first = text.find(':');
+	size_t second = (first == string::npos) ? string::npos : text.find(':', first + 1);
 
-				// Attempt to Capture Pokemon
-				catchAttempt = throwPokeball(trainer, attackingPokemon, battleStatus);
+	if (second == string::npos)
+	{
+		return false;
+	}
 
-				if (catchAttempt == CAUGHT)
-				{
-					// Caught Pokemon
-					message.insert(message.end(), { "GOTCHA! Wild ", attackingPokemon.name, " was caught!" });
-				}
-				else
-				{
-					// Failed to Capture Pokemon or Trainer already has 6 Pokemon
-					message.insert(message.end(), "Oh, no! The POKEMON broke free!");
-				}
+	string metric = text.substr(0, first);
+	for (int m = 0; m < LATENCY_METRICS; m++)
+	{
+		if (metric == LatencyMetricNames[m])
+		{
+			objective.metric = static_cast<LatencyMetric>(m);
 
-				// Draw Battle UI with Status Message
-				drawBattleUIStatus(trainer, attackingPokemon, multipleStrings(message));
-			}
-			else
-			{
-				// Player doesn't have any Pokeballs
-				drawBattleUIStatus(trainer, attackingPokemon, "You do not have any of that item.");
-			}
+			const char *percentile = text.data() + first + 1;
+			const char *limit = text.data() + second + 1;
+			auto [percentileEnd, percentileError] = from_chars(percentile, text.data() + second, objective.percentile);
+			auto [limitEnd, limitError] = from_chars(limit, text.data() + text.size(), objective.limitMicros);
 
-			battleStatus = BATTLE_CONTINUE;
-			break;
-		case 3:
-			drawBattleUI(trainer, attackingPokemon, OVERVIEW, battleStatus);
-			break;
+			return percentileError == errc() && percentileEnd == text.data() + second && limitError == errc() && limitEnd == text.data() + text.size()
+				&& objective.percentile > 0 && objective.percentile <= 100 && objective.limitMicros > 0;
 		}
-		break;
-	case SELECTION:
-		if (menuSelection == 7)
+	}
+
+	return false;
+}
+// *******************************************
+//           addSaveLatency
+//    Adds the save and store write times
+//    (Kept with the Save Statistics, saves
+//    run on the Save Worker) to latency.
+//********************************************
+void addSaveLatency(LatencyStatistics &latency)
+{
+	latency.metrics[LATENCY_SAVE].merge(saveStats.saveLatency);
+	latency.metrics[LATENCY_STORE_WRITE].merge(saveStats.storeWriteLatency);
+}
+// *******************************************
+//           printLatencyStatistics
+//    Lists each latency metric's count, mean
+//    and percentiles up to p99.99 in us.
+//********************************************
+void printLatencyStatistics(const LatencyStatistics &latency)
+{
+	const double percentiles[] = { 50, 90, 99, 99.9, 99.99 };
+
+	cout << fixed << setprecision(2);
+	cout << "Latency (us):" << endl;
+	cout << "  " << left << setfill(' ') << setw(16) << "metric" << right << setw(10) << "count" << setw(10) << "mean";
+	for (const char *heading : { "p50", "p90", "p99", "p99.9", "p99.99" })
+	{
+		cout << setw(10) << heading;
+	}
+	cout << setw(10) << "max" << endl;
+
+	for (int m = 0; m < LATENCY_METRICS; m++)
+	{
+		const LatencyHistogram &histogram = latency.metrics[m];
+
+		if (histogram.total == 0)
 		{
-			drawBattleUI(trainer, attackingPokemon, OVERVIEW, battleStatus);
+			continue;
 		}
-		else
+
+		cout << "  " << left << setw(16) << LatencyMetricNames[m] << right << setw(10) << histogram.total << setw(10) << histogram.mean() / 1e3;
+		for (double percentile : percentiles)
 		{
-			swapPokemon(trainer, menuSelection);
+			cout << setw(10) << histogram.percentile(percentile) / 1e3;
 		}
-		battleStatus = BATTLE_CONTINUE;
-		break;
+		cout << setw(10) << histogram.largest / 1e3 << endl;
 	}
 }
 // *******************************************
+//           checkLatencyObjectives
+//    Checks every --slo against latency and
+//    reports each one. Returns false if any
+//    objective was missed.
+//********************************************
+bool checkLatencyObjectives(const LatencyStatistics &latency)
+{
+	bool met = true;
+
+	for (const LatencyObjective &objective : latencyObjectives)
+	{
+		const LatencyHistogram &histogram = latency.metrics[objective.metric];
+		double measured = histogram.percentile(objective.percentile) / 1e3;
+		bool ok = measured <= objective.limitMicros;
+
+		cout << "SLO " << LatencyMetricNames[objective.metric] << " p" << defaultfloat << setprecision(6) << objective.percentile << " <= " << objective.limitMicros
+			<< " us: " << fixed << setprecision(2) << measured << " us over " << histogram.total << " samples, " << (ok ? "met" : "MISSED") << endl;
+
+		met = met && ok;
+	}
+
+	return met;
+}
+// *******************************************
 //           getMenuSelection
 //    Helper Function for getting input from
 //    menu system.
 //********************************************
 int getMenuSelection()
 {
-	// Storage
-	int value;
+	PROFILE_SCOPE(PROFILE_MENU_SELECTION);
 
+	// Ask
+	promptSelection();
+
+	// Return Value
+	return readSelection();
+}
+// *******************************************
+//           promptSelection
+//    Asks for a Menu Selection
+//********************************************
+void promptSelection()
+{
 	// Spacing
-	cout << endl;
+	screen << endl;
 
 	// Get User Input
-	cout << "Enter Selection: ";
-	cin >> value;
+	screen << "Enter Selection: ";
+}
+// *******************************************
+//           readSelection
+//    Sends the Frame and reads the Selection
+//********************************************
+int readSelection()
+{
+	PROFILE_SCOPE(PROFILE_INPUT_WAIT);
+	TraceSpan span("input");
+
+	// Storage
+	int value;
+
+	terminal->output.present();
+
+	// Not a Number (Drop the rest of the line but keep its Enter, the caller ignores that)
+	if (!(terminal->input >> value))
+	{
+		terminal->input.clear();
+		while (terminal->input.peek() != '\n' && terminal->input.peek() != istream::traits_type::eof())
+		{
+			terminal->input.get();
+		}
+		value = 0;
+	}
+
+	terminal->output.inputArrived();
 
 	// Return Value
 	return value;
 }
 // *******************************************
 //           gameExists
-//    Checks if Save File Exists
+//    Checks if any Trainer is Saved
 //********************************************
 bool gameExists()
 {
-	ifstream saveFile("save.txt");
+	lock_guard<mutex> guard(trainerStore.lock);
 
-	return static_cast<bool>(saveFile);
+	return trainerStore.trainerCount > 0;
 }